@@ -0,0 +1,93 @@
+// Adafruit SPI Flash FatFs Defragment Example
+//
+// This example makes every fragmented file on the flash filesystem
+// contiguous so that it can be read with large sequential transfers.
+// Files that grow a little at a time (e.g datalogging) end up with their
+// clusters interleaved with those of other files.
+//
+// Usage:
+// - Upload this sketch to your board with a flash chip formatted with
+//   the SdFat_format example.
+// - Open the serial monitor at 115200 baud.
+//
+// Note: the filesystem must not be mounted while defragmenting since
+// FatVolume caches FAT and directory sectors. Mount it (again) afterwards.
+
+#include "SdFat_Adafruit_Fork.h"
+#include <SPI.h>
+
+#include <Adafruit_FatDefrag.h>
+#include <Adafruit_SPIFlash.h>
+
+// for flashTransport definition
+#include "flash_config.h"
+
+Adafruit_SPIFlash flash(&flashTransport);
+Adafruit_FatDefrag defrag(&flash);
+
+// file system object from SdFat
+FatVolume fatfs;
+
+void setup() {
+  // Initialize serial port and wait for it to open before continuing.
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  }
+  Serial.println("Adafruit SPI Flash FatFs Defragment Example");
+
+  // Initialize flash library and check its chip ID.
+  if (!flash.begin()) {
+    Serial.println("Error, failed to initialize flash chip!");
+    while (1) {
+      delay(1);
+    }
+  }
+  Serial.print("Flash chip JEDEC ID: 0x");
+  Serial.println(flash.getJEDECID(), HEX);
+
+  if (!defrag.begin()) {
+    Serial.println("Error, no FAT filesystem found!");
+    Serial.println(
+        "Was the flash chip formatted with the SdFat_format example?");
+    while (1) {
+      delay(1);
+    }
+  }
+
+  uint32_t const start_ms = millis();
+  int32_t const moved = defrag.defragment();
+
+  if (moved < 0) {
+    Serial.println("Error, failed to access flash while defragmenting!");
+    while (1) {
+      delay(1);
+    }
+  }
+
+  Serial.print("Moved ");
+  Serial.print(moved);
+  Serial.print(" file(s) in ");
+  Serial.print(millis() - start_ms);
+  Serial.println(" ms");
+
+  if (defrag.fragmentedCount()) {
+    Serial.print(defrag.fragmentedCount());
+    Serial.println(" file(s) left fragmented, not enough free space");
+  }
+
+  // Mount the filesystem now that defragmentation is done
+  if (!fatfs.begin(&flash)) {
+    Serial.println("Error, failed to mount filesystem!");
+    while (1) {
+      delay(1);
+    }
+  }
+
+  Serial.println("Files:");
+  fatfs.ls(&Serial, LS_R | LS_SIZE);
+}
+
+void loop() {
+  // nothing to do
+}
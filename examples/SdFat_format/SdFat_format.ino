@@ -203,6 +203,13 @@ DRESULT disk_ioctl(BYTE pdrv, /* Physical drive nmuber (0..) */
     *((DWORD *)buff) = 8; // erase block size in units of sector size
     return RES_OK;
 
+  case CTRL_TRIM: {
+    // first and last sector no longer used
+    DWORD const *range = (DWORD const *)buff;
+    return flash.discard(range[0], range[1] - range[0] + 1) ? RES_OK
+                                                             : RES_ERROR;
+  }
+
   default:
     return RES_PARERR;
   }
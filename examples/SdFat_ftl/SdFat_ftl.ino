@@ -0,0 +1,103 @@
+// Adafruit SPI Flash FatFs Wear Leveling Example
+//
+// This example puts a FAT filesystem on top of the Adafruit_FlashFTL wear
+// leveling block device and appends a line to a log file every second.
+// Without it, the FAT and directory sectors are erased on every update and
+// wear out long before the rest of the flash. With it, each update is written
+// to a new pre-erased location.
+//
+// Usage:
+// - Upload this sketch to your board. The flash is formatted on the first
+//   run: any existing filesystem is lost!
+// - Open the serial monitor at 115200 baud.
+//
+// Note: the FTL layout is not compatible with a plain FAT volume, the flash
+// cannot be mounted by CircuitPython or the other examples anymore. Use the
+// SdFat_format example to go back to a plain volume.
+
+#include "SdFat_Adafruit_Fork.h"
+#include <SPI.h>
+
+#include <Adafruit_FlashFTL.h>
+#include <Adafruit_SPIFlash.h>
+
+// for flashTransport definition
+#include "flash_config.h"
+
+// FTL writes directly to flash, no cache
+Adafruit_SPIFlash flash(&flashTransport, false);
+Adafruit_FlashFTL ftl(&flash);
+
+// file system object from SdFat
+FatVolume fatfs;
+
+uint32_t last_ms = 0;
+uint32_t count = 0;
+
+void setup() {
+  // Initialize serial port and wait for it to open before continuing.
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  }
+  Serial.println("Adafruit SPI Flash FatFs Wear Leveling Example");
+
+  // Initialize flash library and check its chip ID.
+  if (!flash.begin()) {
+    Serial.println("Error, failed to initialize flash chip!");
+    while (1) {
+      delay(1);
+    }
+  }
+  Serial.print("Flash chip JEDEC ID: 0x");
+  Serial.println(flash.getJEDECID(), HEX);
+
+  if (!ftl.begin()) {
+    Serial.println("Error, not enough memory for the FTL mapping table!");
+    while (1) {
+      delay(1);
+    }
+  }
+
+  // First run: format the FTL volume
+  if (!fatfs.begin(&ftl)) {
+    Serial.println("No filesystem found, formatting...");
+
+    FatFormatter formatter;
+    uint8_t sector_buf[512];
+
+    if (!formatter.format(&ftl, sector_buf, &Serial) || !fatfs.begin(&ftl)) {
+      Serial.println("Error, failed to format filesystem!");
+      while (1) {
+        delay(1);
+      }
+    }
+  }
+
+  Serial.print("Volume size: ");
+  Serial.print(ftl.sectorCount() / 2);
+  Serial.println(" KB");
+}
+
+void loop() {
+  if (millis() - last_ms >= 1000) {
+    last_ms = millis();
+
+    File32 file = fatfs.open("log.txt", FILE_WRITE);
+    if (!file) {
+      Serial.println("Error, failed to open log.txt!");
+      return;
+    }
+
+    file.print("Line ");
+    file.println(count++);
+    file.close();
+
+    Serial.print("Logged line ");
+    Serial.println(count);
+  }
+
+  // Collect outdated copies and erase free sectors in between so that the
+  // next write does not have to wait for it.
+  ftl.background();
+}
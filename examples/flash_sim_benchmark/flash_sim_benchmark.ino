@@ -0,0 +1,598 @@
+// The MIT License (MIT)
+// Copyright (c) 2026 Adafruit Industries
+
+/* This example runs benchmarks against a simulated flash device
+ * (Adafruit_FlashTransport_Sim), no flash hardware is needed. Timing comes
+ * from the simulator's model of the device (SPI clock, tPP, tSE, tBE), so
+ * results are the same on every board and on a workstation.
+ *
+ * - Cache lines: write amplification of a typical SdFat append workload with
+ *   1 to 8 cache lines.
+ * - Sequential write: bytes read back and time of large aligned writes, as
+ *   done by writeSectors() for big files.
+ * - Non-blocking: how much of a block erase and a 4 KB write is available to
+ *   the main loop with startEraseBlock()/startWrite() and poll().
+ * - Suspend: latency of a 512 byte read issued during a sector erase, with and
+ *   without erase suspend/resume.
+ * - Erase range: erasing the whole device with sector erases vs eraseRange(),
+ *   which mixes 64K, 32K and 4K erases and can skip blank sectors.
+ * - Quad I/O: 512 byte sector reads with 0x6B, 0xEB and 0xEB in continuous
+ *   read mode.
+ * - Write pipelining: writeBuffer() of 4 KB with and without pipelined page
+ *   programs, compared to the time the device spends programming (tPP).
+ * - Vectored read: scattered small reads like FAT and directory lookups, with
+ *   readBuffer() each vs a single readBufferV().
+ * - Warm boot: bus time of begin() vs beginWarm() with the device saved by a
+ *   previous begin(), as after waking up from deep sleep. The 30 us wait after
+ *   reset in begin() is not included.
+ */
+
+#include "SdFat_Adafruit_Fork.h"
+#include <SPI.h>
+
+#include "Adafruit_SPIFlash.h"
+
+// Simulate a W25Q16JV-IQ, shrunk to 64 KB so that it fits in RAM
+SPIFlash_Device_t sim_device = W25Q16JV_IQ;
+#define SIM_FLASH_SIZE (64 * 1024UL)
+
+Adafruit_FlashTransport_Sim *sim;
+Adafruit_SPIFlash *flash;
+
+bool sim_begin(uint8_t cache_lines) {
+  sim_device.total_size = SIM_FLASH_SIZE;
+
+  sim = new Adafruit_FlashTransport_Sim(&sim_device);
+  flash = new Adafruit_SPIFlash(sim, true, cache_lines);
+
+  if (!flash->begin(&sim_device, 1) || !sim->data()) {
+    Serial.println("Error, not enough RAM to simulate flash device");
+    return false;
+  }
+
+  flash->eraseChip();
+  flash->waitUntilReady();
+  sim->resetStats();
+
+  return true;
+}
+
+void sim_end(void) {
+  flash->end();
+  delete flash;
+  delete sim;
+}
+
+//--------------------------------------------------------------------+
+// Cache lines
+//--------------------------------------------------------------------+
+
+// FAT12 layout of a 2 MB volume formatted by SdFat_format (512 byte sectors).
+// Clusters are one sector.
+#define LBA_FAT1 1
+#define LBA_FAT2 13
+#define LBA_ROOT_DIR 25
+#define LBA_DATA 57
+
+#define RECORD_SIZE 64
+#define RECORD_COUNT 256 // 16 KB in total
+#define RECORDS_PER_SYNC 16
+
+// Mimic the block traffic of SdFat FatFile::write() appending to a file, with
+// a single sector cache shared by FAT, directory and data
+// (USE_SEPARATE_FAT_CACHE = 0).
+uint8_t fs_cache[512];
+uint32_t fs_cache_lba;
+bool fs_cache_dirty;
+
+void fs_cache_flush(void) {
+  if (fs_cache_dirty) {
+    flash->writeSector(fs_cache_lba, fs_cache);
+
+    // FAT sectors are mirrored to the second FAT
+    if (fs_cache_lba >= LBA_FAT1 && fs_cache_lba < LBA_FAT2) {
+      flash->writeSector(fs_cache_lba + LBA_FAT2 - LBA_FAT1, fs_cache);
+    }
+
+    fs_cache_dirty = false;
+  }
+}
+
+uint8_t *fs_cache_modify(uint32_t lba) {
+  if (lba != fs_cache_lba) {
+    fs_cache_flush();
+    flash->readSector(lba, fs_cache);
+    fs_cache_lba = lba;
+  }
+
+  fs_cache_dirty = true;
+  return fs_cache;
+}
+
+void fs_append_workload(void) {
+  fs_cache_lba = 0xFFFFFFFF;
+  fs_cache_dirty = false;
+
+  for (uint32_t pos = 0; pos < RECORD_COUNT * RECORD_SIZE;
+       pos += RECORD_SIZE) {
+    // allocate a new cluster: update FAT12 entry
+    if ((pos % 512) == 0) {
+      uint32_t const cluster = 2 + pos / 512;
+      uint32_t const fat_offset = cluster + cluster / 2;
+
+      uint8_t *fat = fs_cache_modify(LBA_FAT1 + fat_offset / 512);
+      fat[fat_offset % 512] = 0;
+    }
+
+    // append record to data sector
+    uint8_t *data = fs_cache_modify(LBA_DATA + pos / 512);
+    memset(data + (pos % 512), 'A' + (pos / RECORD_SIZE) % 26, RECORD_SIZE);
+
+    // file.sync(): update size in directory entry and sync device
+    if (((pos / RECORD_SIZE) + 1) % RECORDS_PER_SYNC == 0) {
+      uint8_t *dir = fs_cache_modify(LBA_ROOT_DIR);
+      memcpy(dir + 28, &pos, 4);
+
+      fs_cache_flush();
+      flash->syncDevice();
+    }
+  }
+}
+
+void bench_cache_lines(void) {
+  Serial.print("Append workload: ");
+  Serial.print(RECORD_COUNT);
+  Serial.print(" records of ");
+  Serial.print(RECORD_SIZE);
+  Serial.print(" bytes, sync every ");
+  Serial.print(RECORDS_PER_SYNC);
+  Serial.println(" records");
+  Serial.println("Lines\tErases\tPrograms\tWrite Amplification\tTime (ms)");
+
+  for (uint8_t lines = 1; lines <= 8; lines++) {
+    if (!sim_begin(lines)) {
+      sim_end();
+      return;
+    }
+
+    fs_append_workload();
+
+    SPIFlash_SimStats_t const *stats = sim->getStats();
+    float const wa =
+        (float)stats->program_bytes / (RECORD_COUNT * RECORD_SIZE);
+
+    Serial.print(lines);
+    Serial.print('\t');
+    Serial.print(stats->sector_erases);
+    Serial.print('\t');
+    Serial.print(stats->page_programs);
+    Serial.print("\t\t");
+    Serial.print(wa, 2);
+    Serial.print("\t\t\t");
+    Serial.println(sim->timeNs() / 1000000.0F, 1);
+
+    sim_end();
+  }
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Sequential write
+//--------------------------------------------------------------------+
+
+#define SEQ_WRITE_SIZE (32 * 1024UL)
+#define SEQ_BLOCKS_PER_WRITE 8 // 4 KB per writeSectors() call
+
+uint8_t buf[512 * SEQ_BLOCKS_PER_WRITE];
+
+void bench_sequential_write(void) {
+  memset(buf, 0x55, sizeof(buf));
+
+  Serial.print("Sequential write: ");
+  Serial.print(SEQ_WRITE_SIZE / 1024);
+  Serial.print(" KB in ");
+  Serial.print(sizeof(buf));
+  Serial.println(" bytes writeSectors()");
+
+  if (!sim_begin(1)) {
+    sim_end();
+    return;
+  }
+
+  for (uint32_t lba = 0; lba < SEQ_WRITE_SIZE / 512;
+       lba += SEQ_BLOCKS_PER_WRITE) {
+    flash->writeSectors(lba, buf, SEQ_BLOCKS_PER_WRITE);
+  }
+  flash->syncDevice();
+
+  SPIFlash_SimStats_t const *stats = sim->getStats();
+  float const ms = sim->timeNs() / 1000000.0F;
+
+  Serial.print("Read back: ");
+  Serial.print(stats->read_bytes);
+  Serial.print(" bytes, erases: ");
+  Serial.print(stats->sector_erases);
+  Serial.print(", time: ");
+  Serial.print(ms, 1);
+  Serial.print(" ms, speed: ");
+  Serial.print(SEQ_WRITE_SIZE / ms, 1);
+  Serial.println(" KB/s");
+
+  sim_end();
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Non-blocking
+//--------------------------------------------------------------------+
+
+// main loop work between two polls
+#define LOOP_WORK_US 100
+
+void print_loop_count(const char *name, uint64_t start_ns, uint32_t count) {
+  float const ms = (sim->timeNs() - start_ns) / 1000000.0F;
+  float const busy = count * LOOP_WORK_US / 1000.0F;
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(ms, 1);
+  Serial.print(" ms, main loop ran ");
+  Serial.print(count);
+  Serial.print(" times (");
+  Serial.print(100 * busy / ms, 1);
+  Serial.println("% of time)");
+}
+
+void bench_non_blocking(void) {
+  Serial.print("Non-blocking: ");
+  Serial.print(LOOP_WORK_US);
+  Serial.println(" us of main loop work between polls");
+
+  if (!sim_begin(0)) {
+    sim_end();
+    return;
+  }
+
+  uint64_t start_ns = sim->timeNs();
+  uint32_t count = 0;
+
+  flash->startEraseBlock(0);
+  while (!flash->poll()) {
+    sim->advanceTime(LOOP_WORK_US);
+    count++;
+  }
+  print_loop_count("Block erase", start_ns, count);
+
+  memset(buf, 0x55, sizeof(buf));
+  start_ns = sim->timeNs();
+  count = 0;
+
+  flash->startWrite(0, buf, sizeof(buf));
+  while (!flash->poll()) {
+    sim->advanceTime(LOOP_WORK_US);
+    count++;
+  }
+  print_loop_count("4 KB write", start_ns, count);
+
+  sim_end();
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Suspend
+//--------------------------------------------------------------------+
+
+void bench_suspend(void) {
+  Serial.println("Suspend: 512 byte read during a sector erase");
+
+  for (uint8_t i = 0; i < 2; i++) {
+    bool const suspend = (i == 1);
+    sim_device.supports_suspend = suspend;
+
+    if (!sim_begin(0)) {
+      sim_end();
+      return;
+    }
+
+    flash->eraseSector(0);
+
+    uint64_t const start_ns = sim->timeNs();
+    flash->readBuffer(SIM_FLASH_SIZE / 2, buf, 512);
+
+    Serial.print(suspend ? "With suspend: " : "Without suspend: ");
+    Serial.print((uint32_t)((sim->timeNs() - start_ns) / 1000));
+    Serial.println(" us");
+
+    sim_end();
+  }
+
+  sim_device.supports_suspend = true;
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Erase range
+//--------------------------------------------------------------------+
+
+void print_erase(const char *name, uint64_t start_ns) {
+  SPIFlash_SimStats_t const *stats = sim->getStats();
+
+  Serial.print(name);
+  Serial.print(": 4K ");
+  Serial.print(stats->sector_erases);
+  Serial.print(", 32K ");
+  Serial.print(stats->block32_erases);
+  Serial.print(", 64K ");
+  Serial.print(stats->block_erases);
+  Serial.print(", time: ");
+  Serial.print((sim->timeNs() - start_ns) / 1000000.0F, 1);
+  Serial.println(" ms");
+}
+
+// Make every sector dirty, or only a few of them
+void dirty_sectors(bool all) {
+  for (uint32_t addr = 0; addr < SIM_FLASH_SIZE; addr += SFLASH_SECTOR_SIZE) {
+    if (all || addr == SFLASH_SECTOR_SIZE || addr == 9 * SFLASH_SECTOR_SIZE) {
+      flash->writeBuffer(addr, buf, 16);
+    }
+  }
+  flash->waitUntilReady();
+  sim->resetStats();
+}
+
+void bench_erase_range(void) {
+  Serial.print("Erase range: ");
+  Serial.print(SIM_FLASH_SIZE / 1024);
+  Serial.println(" KB");
+
+  if (!sim_begin(0)) {
+    sim_end();
+    return;
+  }
+
+  memset(buf, 0, sizeof(buf));
+
+  dirty_sectors(true);
+  uint64_t start_ns = sim->timeNs();
+  for (uint32_t i = 0; i < SIM_FLASH_SIZE / SFLASH_SECTOR_SIZE; i++) {
+    flash->eraseSector(i);
+  }
+  flash->waitUntilReady();
+  print_erase("eraseSector()", start_ns);
+
+  dirty_sectors(true);
+  start_ns = sim->timeNs();
+  flash->eraseRange(0, SIM_FLASH_SIZE);
+  flash->waitUntilReady();
+  print_erase("eraseRange()", start_ns);
+
+  dirty_sectors(false);
+  start_ns = sim->timeNs();
+  flash->eraseRange(0, SIM_FLASH_SIZE, true);
+  flash->waitUntilReady();
+  print_erase("eraseRange() 2 dirty sectors, skip blank", start_ns);
+
+  dirty_sectors(true);
+  start_ns = sim->timeNs();
+  flash->eraseRange(SFLASH_SECTOR_SIZE, SIM_FLASH_SIZE - SFLASH_SECTOR_SIZE);
+  flash->waitUntilReady();
+  print_erase("eraseRange() from 4K", start_ns);
+
+  sim_end();
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Quad I/O
+//--------------------------------------------------------------------+
+
+#define QUAD_IO_SECTORS 64 // 32 KB
+
+void bench_quad_io(void) {
+  Serial.print("Quad I/O: ");
+  Serial.print(QUAD_IO_SECTORS);
+  Serial.println(" readSector() of 512 bytes");
+
+  const char *names[] = {"0x6B", "0xEB", "0xEB continuous"};
+
+  for (uint8_t i = 0; i < 3; i++) {
+    sim_device.supports_quad_io = (i > 0);
+    sim_device.supports_continuous_read = (i > 1);
+
+    if (!sim_begin(0)) {
+      sim_end();
+      return;
+    }
+
+    uint64_t const start_ns = sim->timeNs();
+    for (uint32_t lba = 0; lba < QUAD_IO_SECTORS; lba++) {
+      flash->readSector(lba, buf);
+    }
+    float const ms = (sim->timeNs() - start_ns) / 1000000.0F;
+
+    Serial.print(names[i]);
+    Serial.print(": ");
+    Serial.print(ms, 3);
+    Serial.print(" ms, speed: ");
+    Serial.print(QUAD_IO_SECTORS * 512 / 1024 / ms * 1000, 1);
+    Serial.println(" KB/s");
+
+    sim_end();
+  }
+
+  sim_device.supports_quad_io = true;
+  sim_device.supports_continuous_read = true;
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Write pipelining
+//--------------------------------------------------------------------+
+
+#define PIPELINE_WRITE_SIZE (32 * 1024UL)
+
+void bench_write_pipelining(void) {
+  Serial.print("Write pipelining: ");
+  Serial.print(PIPELINE_WRITE_SIZE / 1024);
+  Serial.print(" KB in ");
+  Serial.print(sizeof(buf));
+  Serial.println(" bytes writeBuffer()");
+
+  memset(buf, 0x55, sizeof(buf));
+
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!sim_begin(0)) {
+      sim_end();
+      return;
+    }
+
+    flash->setWritePipelining(i > 0);
+
+    uint64_t const start_ns = sim->timeNs();
+    for (uint32_t addr = 0; addr < PIPELINE_WRITE_SIZE; addr += sizeof(buf)) {
+      flash->writeBuffer(addr, buf, sizeof(buf));
+    }
+    flash->waitUntilReady();
+
+    float const ms = (sim->timeNs() - start_ns) / 1000000.0F;
+    float const tpp_ms = sim->getStats()->page_programs *
+                         sim->getTiming()->page_program_us / 1000.0F;
+
+    Serial.print(i ? "Pipelined" : "Serial");
+    Serial.print(": ");
+    Serial.print(ms, 2);
+    Serial.print(" ms, speed: ");
+    Serial.print(PIPELINE_WRITE_SIZE / ms, 1);
+    Serial.print(" KB/s, tPP: ");
+    Serial.print(tpp_ms, 2);
+    Serial.print(" ms, status reads: ");
+    Serial.println(sim->getStats()->status_reads);
+
+    sim_end();
+  }
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Vectored read
+//--------------------------------------------------------------------+
+
+#define VEC_SEGMENTS 16
+#define VEC_SEGMENT_SIZE 32
+
+void bench_vectored_read(void) {
+  Serial.print("Vectored read: ");
+  Serial.print(VEC_SEGMENTS);
+  Serial.print(" scattered reads of ");
+  Serial.print(VEC_SEGMENT_SIZE);
+  Serial.println(" bytes");
+
+  if (!sim_begin(0)) {
+    sim_end();
+    return;
+  }
+
+  FlashIoVec iov[VEC_SEGMENTS];
+  for (uint8_t i = 0; i < VEC_SEGMENTS; i++) {
+    iov[i].addr = i * (SIM_FLASH_SIZE / VEC_SEGMENTS) + 100;
+    iov[i].buf = buf + i * VEC_SEGMENT_SIZE;
+    iov[i].len = VEC_SEGMENT_SIZE;
+  }
+
+  uint64_t start_ns = sim->timeNs();
+  for (uint8_t i = 0; i < VEC_SEGMENTS; i++) {
+    flash->readBuffer(iov[i].addr, iov[i].buf, iov[i].len);
+  }
+  Serial.print("readBuffer(): ");
+  Serial.print((sim->timeNs() - start_ns) / 1000.0F, 2);
+  Serial.println(" us");
+
+  start_ns = sim->timeNs();
+  flash->readBufferV(iov, VEC_SEGMENTS);
+  Serial.print("readBufferV(): ");
+  Serial.print((sim->timeNs() - start_ns) / 1000.0F, 2);
+  Serial.println(" us");
+
+  sim_end();
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Warm boot
+//--------------------------------------------------------------------+
+
+// Keep in RAM retained during deep sleep on real hardware
+SPIFlash_State_t warm_state;
+
+void print_begin(const char *name, uint64_t start_ns, uint32_t commands) {
+  Serial.print(name);
+  Serial.print((sim->timeNs() - start_ns) / 1000.0F, 2);
+  Serial.print(" us, ");
+  Serial.print(sim->getStats()->commands - commands);
+  Serial.println(" commands");
+}
+
+void bench_warm_boot(void) {
+  Serial.println("Warm boot: begin() vs beginWarm()");
+
+  if (!sim_begin(0)) {
+    sim_end();
+    return;
+  }
+
+  // Simulated MCU reset, flash keeps its state
+  flash->end();
+
+  uint64_t start_ns = sim->timeNs();
+  uint32_t commands = sim->getStats()->commands;
+  flash->begin(&sim_device, 1);
+  print_begin("begin(): ", start_ns, commands);
+
+  flash->saveState(&warm_state);
+  flash->end();
+
+  start_ns = sim->timeNs();
+  commands = sim->getStats()->commands;
+  flash->beginWarm(&warm_state, &sim_device, 1);
+  print_begin("beginWarm(): ", start_ns, commands);
+
+  sim_end();
+
+  Serial.println();
+}
+
+//--------------------------------------------------------------------+
+// Arduino
+//--------------------------------------------------------------------+
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100); // wait for native usb
+  }
+
+  Serial.println("Adafruit SPIFlash simulated device benchmark");
+  Serial.println();
+
+  bench_cache_lines();
+  bench_sequential_write();
+  bench_non_blocking();
+  bench_suspend();
+  bench_erase_range();
+  bench_quad_io();
+  bench_write_pipelining();
+  bench_vectored_read();
+  bench_warm_boot();
+
+  Serial.println("Benchmark is completed.");
+}
+
+void loop() {
+  // nothing to do
+}
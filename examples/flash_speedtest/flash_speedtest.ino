@@ -47,7 +47,16 @@ void setup() {
   Serial.println(flash.size());
   Serial.flush();
 
+  // Page programs one after another, then pipelined by the transport. Pages
+  // still program one at a time: pipelining saves the status read and Write
+  // Enable transactions between pages, not the page program time (tPP).
+  Serial.println("Write pipelining off: status read and WREN per page");
+  flash.setWritePipelining(false);
   write_and_compare(0xAA);
+
+  Serial.println("Write pipelining on: saves per page command overhead, "
+                 "not tPP");
+  flash.setWritePipelining(true);
   write_and_compare(0x55);
 
   Serial.println("Speed test is completed.");
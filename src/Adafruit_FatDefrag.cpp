@@ -0,0 +1,500 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_FatDefrag.h"
+
+#define INVALID_LBA 0xffffffff
+
+// Subdirectories deeper than this are not defragmented
+#define MAX_DIR_DEPTH 8
+
+// Logical sectors per flash erase sector
+#define SECTORS_PER_ERASE (SFLASH_SECTOR_SIZE / 512)
+
+static inline uint16_t get_le16(uint8_t const *buf) {
+  return buf[0] | (buf[1] << 8);
+}
+
+static inline uint32_t get_le32(uint8_t const *buf) {
+  return get_le16(buf) | ((uint32_t)get_le16(buf + 2) << 16);
+}
+
+Adafruit_FatDefrag::Adafruit_FatDefrag(Adafruit_SPIFlash *flash) {
+  _flash = flash;
+  _fat_type = 0;
+  _fat_buf_lba = _dir_buf_lba = INVALID_LBA;
+  _fat_dirty = false;
+  _max_files = _moved = _fragmented = 0;
+}
+
+bool Adafruit_FatDefrag::begin(void) {
+  _fat_type = 0;
+  _fat_buf_lba = _dir_buf_lba = INVALID_LBA;
+  _fat_dirty = false;
+
+  uint8_t *buf = _dir_buf;
+  uint32_t part_lba = 0;
+
+  if (!_flash->readSectors(0, buf, 1) || buf[510] != 0x55 || buf[511] != 0xAA) {
+    return false;
+  }
+
+  // Not a boot sector (no jump instruction): MBR, use 1st partition
+  if (buf[0] != 0xEB && buf[0] != 0xE9) {
+    part_lba = get_le32(buf + 446 + 8);
+
+    if (!_flash->readSectors(part_lba, buf, 1) || buf[510] != 0x55 ||
+        buf[511] != 0xAA) {
+      return false;
+    }
+  }
+
+  uint8_t const spc = buf[13];
+  uint16_t const reserved = get_le16(buf + 14);
+  uint16_t const root_entries = get_le16(buf + 17);
+
+  uint32_t total = get_le16(buf + 19);
+  if (total == 0) {
+    total = get_le32(buf + 32);
+  }
+
+  uint32_t fat_size = get_le16(buf + 22);
+  if (fat_size == 0) {
+    fat_size = get_le32(buf + 36);
+  }
+
+  if (get_le16(buf + 11) != 512 || spc == 0 || (spc & (spc - 1)) ||
+      buf[16] == 0 || fat_size == 0) {
+    return false;
+  }
+
+  _sectors_per_cluster = spc;
+  _fat_count = buf[16];
+  _fat_sectors = fat_size;
+  _fat_lba = part_lba + reserved;
+  _root_lba = _fat_lba + _fat_count * fat_size;
+  _root_sectors = (root_entries * 32UL + 511) / 512;
+  _data_lba = _root_lba + _root_sectors;
+
+  uint32_t const meta = reserved + _fat_count * fat_size + _root_sectors;
+  if (total <= meta) {
+    return false;
+  }
+  _cluster_count = (total - meta) / spc;
+
+  // FAT type is determined by cluster count only
+  if (_cluster_count < 4085) {
+    _fat_type = 12;
+  } else if (_cluster_count < 65525) {
+    _fat_type = 16;
+  } else {
+    _fat_type = 32;
+    _root_cluster = get_le32(buf + 44);
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// FAT access
+//--------------------------------------------------------------------+
+
+bool Adafruit_FatDefrag::isEndOfChain(uint32_t value) {
+  if (_fat_type == 12) {
+    return value >= 0xFF8;
+  } else if (_fat_type == 16) {
+    return value >= 0xFFF8;
+  } else {
+    return value >= 0x0FFFFFF8;
+  }
+}
+
+// Write modified FAT sector to every FAT copy
+bool Adafruit_FatDefrag::flushFat(void) {
+  if (_fat_dirty) {
+    for (uint8_t i = 0; i < _fat_count; i++) {
+      if (!_flash->writeSectors(_fat_buf_lba + i * _fat_sectors, _fat_buf,
+                                1)) {
+        return false;
+      }
+    }
+    _fat_dirty = false;
+  }
+
+  return true;
+}
+
+// Byte at offset of the first FAT, loaded into FAT buffer
+uint8_t *Adafruit_FatDefrag::fatByte(uint32_t offset) {
+  uint32_t const lba = _fat_lba + offset / 512;
+
+  if (lba != _fat_buf_lba) {
+    if (!flushFat()) {
+      return NULL;
+    }
+
+    if (!_flash->readSectors(lba, _fat_buf, 1)) {
+      _fat_buf_lba = INVALID_LBA;
+      return NULL;
+    }
+    _fat_buf_lba = lba;
+  }
+
+  return _fat_buf + (offset % 512);
+}
+
+// Return next cluster, or 1 (invalid) on read error
+uint32_t Adafruit_FatDefrag::getFat(uint32_t cluster) {
+  if (_fat_type == 12) {
+    // 12-bit entries can straddle two sectors
+    uint32_t const offset = cluster + cluster / 2;
+    uint8_t *p = fatByte(offset);
+    if (!p) {
+      return 1;
+    }
+    uint16_t value = *p;
+
+    p = fatByte(offset + 1);
+    if (!p) {
+      return 1;
+    }
+    value |= *p << 8;
+
+    return (cluster & 1) ? (value >> 4) : (value & 0xFFF);
+  } else if (_fat_type == 16) {
+    uint8_t *p = fatByte(cluster * 2);
+    return p ? get_le16(p) : 1;
+  } else {
+    uint8_t *p = fatByte(cluster * 4);
+    return p ? (get_le32(p) & 0x0FFFFFFF) : 1;
+  }
+}
+
+bool Adafruit_FatDefrag::setFat(uint32_t cluster, uint32_t value) {
+  if (_fat_type == 12) {
+    uint32_t const offset = cluster + cluster / 2;
+    uint8_t *p = fatByte(offset);
+    if (!p) {
+      return false;
+    }
+    *p = (cluster & 1) ? ((*p & 0x0F) | (value << 4)) : value;
+    _fat_dirty = true;
+
+    p = fatByte(offset + 1);
+    if (!p) {
+      return false;
+    }
+    *p = (cluster & 1) ? (value >> 4) : ((*p & 0xF0) | ((value >> 8) & 0x0F));
+    _fat_dirty = true;
+  } else if (_fat_type == 16) {
+    uint8_t *p = fatByte(cluster * 2);
+    if (!p) {
+      return false;
+    }
+    p[0] = value;
+    p[1] = value >> 8;
+    _fat_dirty = true;
+  } else {
+    uint8_t *p = fatByte(cluster * 4);
+    if (!p) {
+      return false;
+    }
+    // upper 4 bits are reserved and must be preserved
+    value = (value & 0x0FFFFFFF) | (get_le32(p) & 0xF0000000);
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+    _fat_dirty = true;
+  }
+
+  return true;
+}
+
+bool Adafruit_FatDefrag::loadDir(uint32_t lba) {
+  if (lba != _dir_buf_lba) {
+    if (!_flash->readSectors(lba, _dir_buf, 1)) {
+      _dir_buf_lba = INVALID_LBA;
+      return false;
+    }
+    _dir_buf_lba = lba;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Defragment
+//--------------------------------------------------------------------+
+
+// First cluster of a run of count free clusters, 0 if none. If aligned, run
+// must start at a flash erase sector boundary.
+uint32_t Adafruit_FatDefrag::findFree(uint32_t count, bool aligned) {
+  uint32_t start = 0;
+  uint32_t run = 0;
+
+  for (uint32_t c = 2; c < _cluster_count + 2; c++) {
+    if (getFat(c) != 0) {
+      run = 0;
+      continue;
+    }
+
+    if (run == 0) {
+      if (aligned && (clusterLba(c) % SECTORS_PER_ERASE)) {
+        continue;
+      }
+      start = c;
+    }
+
+    if (++run == count) {
+      return start;
+    }
+  }
+
+  return 0;
+}
+
+// Copy file to a contiguous run if fragmented. Return false on I/O error only.
+bool Adafruit_FatDefrag::moveFile(uint32_t dir_lba, uint8_t index,
+                                  uint32_t start) {
+  // walk the chain to get its length and check if it is contiguous
+  uint32_t count = 1;
+  bool contiguous = true;
+
+  for (uint32_t c = start;; count++) {
+    uint32_t const next = getFat(c);
+
+    if (isEndOfChain(next)) {
+      break;
+    }
+
+    // broken chain, leave it to a file system checker
+    if (!isValidCluster(next) || count > _cluster_count) {
+      return true;
+    }
+
+    if (next != c + 1) {
+      contiguous = false;
+    }
+    c = next;
+  }
+
+  if (contiguous) {
+    return true;
+  }
+
+  if (_max_files && _moved >= _max_files) {
+    _fragmented++;
+    return true;
+  }
+
+  uint32_t dst = findFree(count, true);
+  if (!dst) {
+    dst = findFree(count, false);
+  }
+
+  if (!dst) {
+    _fragmented++;
+    return true;
+  }
+
+  // copy data, then link new chain
+  uint32_t c = start;
+  for (uint32_t i = 0; i < count; i++) {
+    for (uint8_t s = 0; s < _sectors_per_cluster; s++) {
+      if (!_flash->readSectors(clusterLba(c) + s, _copy_buf, 1) ||
+          !_flash->writeSectors(clusterLba(dst + i) + s, _copy_buf, 1)) {
+        return false;
+      }
+    }
+
+    uint32_t const next = (i == count - 1) ? 0x0FFFFFFF : (dst + i + 1);
+    if (!setFat(dst + i, next)) {
+      return false;
+    }
+
+    c = getFat(c);
+  }
+
+  if (!flushFat() || !_flash->syncDevice()) {
+    return false;
+  }
+
+  // point directory entry to new chain
+  if (!loadDir(dir_lba)) {
+    return false;
+  }
+
+  uint8_t *entry = _dir_buf + 32 * index;
+  entry[26] = dst;
+  entry[27] = dst >> 8;
+  if (_fat_type == 32) {
+    entry[20] = dst >> 16;
+    entry[21] = dst >> 24;
+  }
+
+  if (!_flash->writeSectors(dir_lba, _dir_buf, 1) || !_flash->syncDevice()) {
+    return false;
+  }
+
+  // free old chain
+  c = start;
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t const next = getFat(c);
+    if (!setFat(c, 0)) {
+      return false;
+    }
+    c = next;
+  }
+
+  if (!flushFat() || !_flash->syncDevice()) {
+    return false;
+  }
+
+  _moved++;
+
+  return true;
+}
+
+// Defragment files of a directory and its subdirectories. Cluster 0 is the
+// fixed root directory of FAT12/16.
+bool Adafruit_FatDefrag::scanDir(uint32_t cluster, uint8_t depth) {
+  for (uint32_t sector = 0;; sector++) {
+    uint32_t lba;
+
+    if (cluster == 0) {
+      if (sector >= _root_sectors) {
+        return true;
+      }
+      lba = _root_lba + sector;
+    } else {
+      // next cluster of the directory
+      if (sector && (sector % _sectors_per_cluster) == 0) {
+        cluster = getFat(cluster);
+        if (!isValidCluster(cluster)) {
+          return true;
+        }
+      }
+      lba = clusterLba(cluster) + (sector % _sectors_per_cluster);
+    }
+
+    for (uint8_t i = 0; i < 512 / 32; i++) {
+      // buffer is reused by subdirectories and file moves
+      if (!loadDir(lba)) {
+        return false;
+      }
+
+      uint8_t const *entry = _dir_buf + 32 * i;
+      uint8_t const attr = entry[11];
+
+      // end of directory
+      if (entry[0] == 0x00) {
+        return true;
+      }
+
+      // skip deleted, dot entries, long file names and volume label
+      if (entry[0] == 0xE5 || entry[0] == '.' || (attr & 0x0F) == 0x0F ||
+          (attr & 0x08)) {
+        continue;
+      }
+
+      uint32_t start = get_le16(entry + 26);
+      if (_fat_type == 32) {
+        start |= ((uint32_t)get_le16(entry + 20)) << 16;
+      }
+
+      // empty file
+      if (!isValidCluster(start)) {
+        continue;
+      }
+
+      if (attr & 0x10) {
+        if (depth < MAX_DIR_DEPTH && !scanDir(start, depth + 1)) {
+          return false;
+        }
+      } else if (!moveFile(lba, i, start)) {
+        return false;
+      }
+    }
+  }
+}
+
+int32_t Adafruit_FatDefrag::discardFree(void) {
+  if (!_fat_type || !flushFat()) {
+    return -1;
+  }
+
+  // volume may have been written since
+  _fat_buf_lba = INVALID_LBA;
+
+  uint32_t start = 0;
+  uint32_t run = 0;
+  uint32_t free_count = 0;
+
+  for (uint32_t c = 2; c < _cluster_count + 2; c++) {
+    uint32_t const value = getFat(c);
+
+    // 1 is not a valid entry, it is returned on read error
+    if (value == 1) {
+      return -1;
+    }
+
+    if (value == 0) {
+      if (run == 0) {
+        start = c;
+      }
+      run++;
+    }
+
+    // end of a run of free clusters
+    if (run && (value != 0 || c == _cluster_count + 1)) {
+      uint32_t const lba = clusterLba(start);
+      if (!_flash->discard(lba, run * _sectors_per_cluster)) {
+        return -1;
+      }
+
+      free_count += run;
+      run = 0;
+    }
+  }
+
+  return free_count;
+}
+
+int32_t Adafruit_FatDefrag::defragment(uint32_t maxFiles) {
+  if (!_fat_type) {
+    return -1;
+  }
+
+  _max_files = maxFiles;
+  _moved = 0;
+  _fragmented = 0;
+
+  uint32_t const root = (_fat_type == 32) ? _root_cluster : 0;
+  if (!scanDir(root, 0) || !flushFat()) {
+    return -1;
+  }
+
+  return _moved;
+}
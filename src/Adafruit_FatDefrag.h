@@ -0,0 +1,112 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ADAFRUIT_FATDEFRAG_H_
+#define ADAFRUIT_FATDEFRAG_H_
+
+#include "Adafruit_SPIFlash.h"
+
+// Defragmenter for a FAT12/16/32 volume on flash. Each fragmented file is
+// copied to a contiguous run of free clusters, starting at a flash erase
+// sector boundary when possible, so that it can later be read with large
+// sequential transfers.
+//
+// It works directly on the FAT structures, the volume must not be mounted
+// (FatVolume caches FAT and directory sectors) while defragmenting. Data is
+// copied first, then the new chain and the directory entry are written before
+// the old clusters are freed, so that an interrupted copy only leaks clusters.
+// This does not protect against power loss while the cache erases and
+// reprograms a flash sector holding FAT, directory or boot sectors: the whole
+// volume can be lost then.
+class Adafruit_FatDefrag {
+public:
+  Adafruit_FatDefrag(Adafruit_SPIFlash *flash);
+
+  // Parse the volume boot record, with or without MBR. Return false if there
+  // is no supported FAT volume.
+  bool begin(void);
+
+  // Move up to maxFiles fragmented files (0 for all). Can be called repeatedly
+  // e.g a file at a time when idle. Return number of files moved, -1 on error.
+  int32_t defragment(uint32_t maxFiles = 0);
+
+  // Fragmented files left by the last defragment(), either because of
+  // maxFiles or because there is no large enough free run of clusters.
+  uint32_t fragmentedCount(void) { return _fragmented; }
+
+  // Discard the sectors of all free clusters, so that flash.idleTask() erases
+  // them ahead of writes (SdFat does not discard freed clusters). The FAT on
+  // flash must be up to date: no file open for writing. Return number of
+  // free clusters, -1 on error.
+  int32_t discardFree(void);
+
+protected:
+  Adafruit_SPIFlash *_flash;
+
+  uint8_t _fat_type; // 12, 16 or 32, 0 if begin() failed
+  uint8_t _fat_count;
+  uint8_t _sectors_per_cluster;
+  uint32_t _fat_lba;
+  uint32_t _fat_sectors; // of each FAT
+  uint32_t _root_lba;    // FAT12/16 fixed root directory
+  uint32_t _root_sectors;
+  uint32_t _root_cluster; // FAT32 root directory
+  uint32_t _data_lba;
+  uint32_t _cluster_count; // clusters are numbered from 2
+
+  uint8_t _fat_buf[512];
+  uint32_t _fat_buf_lba;
+  bool _fat_dirty;
+
+  uint8_t _dir_buf[512];
+  uint32_t _dir_buf_lba;
+
+  uint8_t _copy_buf[512];
+
+  uint32_t _max_files;
+  uint32_t _moved;
+  uint32_t _fragmented;
+
+  uint32_t clusterLba(uint32_t cluster) {
+    return _data_lba + (cluster - 2) * _sectors_per_cluster;
+  }
+
+  bool isEndOfChain(uint32_t value);
+  bool isValidCluster(uint32_t cluster) {
+    return cluster >= 2 && cluster < _cluster_count + 2;
+  }
+
+  uint8_t *fatByte(uint32_t offset);
+  bool flushFat(void);
+  uint32_t getFat(uint32_t cluster);
+  bool setFat(uint32_t cluster, uint32_t value);
+
+  bool loadDir(uint32_t lba);
+
+  uint32_t findFree(uint32_t count, bool aligned);
+  bool scanDir(uint32_t cluster, uint8_t depth);
+  bool moveFile(uint32_t dir_lba, uint8_t index, uint32_t start);
+};
+
+#endif /* ADAFRUIT_FATDEFRAG_H_ */
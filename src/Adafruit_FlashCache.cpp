@@ -26,19 +26,29 @@
 #include "Adafruit_SPIFlashBase.h"
 
 #if SPIFLASH_DEBUG
-#define SPICACHE_LOG(_new_addr)                                                \
+#define SPICACHE_LOG(_flush_addr, _new_addr)                                   \
   do {                                                                         \
     Serial.print(__FUNCTION__);                                                \
     Serial.print(": flush sector = ");                                         \
-    Serial.print(_addr / 512);                                                 \
+    Serial.print(_flush_addr / 512);                                           \
     Serial.print(", new sector = ");                                           \
     Serial.println(_new_addr / 512);                                           \
   } while (0)
 #else
-#define SPICACHE_LOG(_new_addr)
+#define SPICACHE_LOG(_flush_addr, _new_addr)
+#endif
+
+#if SPIFLASH_STATS
+#define STATS_INC(_field) _stats._field++
+#else
+#define STATS_INC(_field)
 #endif
 
 #define INVALID_ADDR 0xffffffff
+#define PAGES_PER_SECTOR (SFLASH_SECTOR_SIZE / SFLASH_PAGE_SIZE)
+
+// Uncached runs of a read() gathered into one vectored flash read
+#define READ_SEGMENTS 4
 
 static inline uint32_t sector_of(uint32_t addr) {
   return addr & ~(SFLASH_SECTOR_SIZE - 1);
@@ -48,23 +58,164 @@ static inline uint32_t offset_of(uint32_t addr) {
   return addr & (SFLASH_SECTOR_SIZE - 1);
 }
 
-Adafruit_FlashCache::Adafruit_FlashCache(void) { _addr = INVALID_ADDR; }
+Adafruit_FlashCache::Adafruit_FlashCache(uint8_t lines) {
+  _tick = 0;
+  _buf = (uint8_t *)malloc(lines * SFLASH_SECTOR_SIZE);
+  _line = (cache_line_t *)malloc(lines * sizeof(cache_line_t));
 
-bool Adafruit_FlashCache::sync(Adafruit_SPIFlashBase *fl) {
-  if (_addr == INVALID_ADDR) {
+  if (_buf == NULL || _line == NULL) {
+    free(_buf);
+    free(_line);
+    _buf = NULL;
+    _line = NULL;
+    lines = 0;
+  }
+
+  _count = lines;
+  for (uint8_t i = 0; i < _count; i++) {
+    _line[i].addr = INVALID_ADDR;
+    _line[i].used = 0;
+    _line[i].dirty = 0;
+    _line[i].blank = false;
+  }
+
+#if SPIFLASH_STATS
+  resetStats();
+#endif
+}
+
+Adafruit_FlashCache::~Adafruit_FlashCache() {
+  free(_buf);
+  free(_line);
+}
+
+int Adafruit_FlashCache::find(uint32_t sector_addr) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_line[i].addr == sector_addr) {
+      _line[i].used = ++_tick;
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Line to be replaced: unused one if any, otherwise least recently used
+uint8_t Adafruit_FlashCache::victim(void) {
+  uint8_t idx = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_line[i].addr == INVALID_ADDR) {
+      return i;
+    }
+
+    // age as difference handles wrap around of tick
+    uint32_t const age = _tick - _line[i].used;
+    if (age > _tick - _line[idx].used) {
+      idx = i;
+    }
+  }
+  return idx;
+}
+
+// Check if dirty pages of a line can be programmed without erasing: flash is
+// the original image of the sector, new data must only clear its bits.
+bool Adafruit_FlashCache::programmable(Adafruit_SPIFlashBase *fl,
+                                       uint8_t idx) {
+  cache_line_t const *line = &_line[idx];
+  uint32_t const *buf32 = (uint32_t const *)line_buf(idx);
+  uint32_t orig[16];
+
+  for (uint32_t pg = 0; pg < PAGES_PER_SECTOR; pg++) {
+    if (!(line->dirty & (1u << pg))) {
+      continue;
+    }
+
+    for (uint32_t off = 0; off < SFLASH_PAGE_SIZE; off += sizeof(orig)) {
+      uint32_t const pos = pg * SFLASH_PAGE_SIZE + off;
+      fl->readBuffer(line->addr + pos, (uint8_t *)orig, sizeof(orig));
+
+      for (uint32_t i = 0; i < sizeof(orig) / 4; i++) {
+        if (buf32[pos / 4 + i] & ~orig[i]) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+bool Adafruit_FlashCache::flush(Adafruit_SPIFlashBase *fl, uint8_t idx) {
+  cache_line_t *line = &_line[idx];
+
+  if (line->addr == INVALID_ADDR || !line->dirty) {
     return true;
   }
 
-  fl->eraseSector(_addr / SFLASH_SECTOR_SIZE);
-  fl->writeBuffer(_addr, _buf, SFLASH_SECTOR_SIZE);
+  STATS_INC(flushes);
+
+  if (line->blank || programmable(fl, idx)) {
+    for (uint32_t pg = 0; pg < PAGES_PER_SECTOR; pg++) {
+      if (line->dirty & (1u << pg)) {
+        uint32_t const pos = pg * SFLASH_PAGE_SIZE;
+        fl->writeBuffer(line->addr + pos, line_buf(idx) + pos,
+                        SFLASH_PAGE_SIZE);
+      }
+    }
+  } else {
+    STATS_INC(flush_erases);
+    fl->eraseSector(line->addr / SFLASH_SECTOR_SIZE);
+    fl->writeBuffer(line->addr, line_buf(idx), SFLASH_SECTOR_SIZE, true);
+  }
 
-  _addr = INVALID_ADDR;
+  line->dirty = 0;
+  line->blank = false;
 
   return true;
 }
 
+bool Adafruit_FlashCache::sync(Adafruit_SPIFlashBase *fl) {
+  for (uint8_t i = 0; i < _count; i++) {
+    flush(fl, i);
+  }
+
+  return true;
+}
+
+bool Adafruit_FlashCache::evict(Adafruit_SPIFlashBase *fl, uint32_t addr,
+                                uint32_t len) {
+  for (uint8_t i = 0; i < _count; i++) {
+    uint32_t const line_addr = _line[i].addr;
+
+    if (line_addr != INVALID_ADDR && line_addr < addr + len &&
+        addr < line_addr + SFLASH_SECTOR_SIZE) {
+      flush(fl, i);
+      _line[i].addr = INVALID_ADDR;
+    }
+  }
+
+  return true;
+}
+
+void Adafruit_FlashCache::drop(uint32_t addr, uint32_t len) {
+  for (uint8_t i = 0; i < _count; i++) {
+    uint32_t const line_addr = _line[i].addr;
+
+    if (line_addr != INVALID_ADDR && line_addr < addr + len &&
+        addr < line_addr + SFLASH_SECTOR_SIZE) {
+      _line[i].addr = INVALID_ADDR;
+      _line[i].dirty = 0;
+    }
+  }
+}
+
 bool Adafruit_FlashCache::write(Adafruit_SPIFlashBase *fl, uint32_t address,
-                                void const *src, uint32_t len) {
+                                void const *src, uint32_t len,
+                                uint8_t sectors) {
+  // memory allocation failed, no line to load a sector into
+  if (_count == 0) {
+    return false;
+  }
+
   uint8_t const *src8 = (uint8_t const *)src;
   uint32_t remain = len;
 
@@ -76,17 +227,71 @@ bool Adafruit_FlashCache::write(Adafruit_SPIFlashBase *fl, uint32_t address,
     uint32_t wr_bytes = SFLASH_SECTOR_SIZE - offset;
     wr_bytes = min(remain, wr_bytes);
 
-    // Flash sector changes, flush old and update new cache
-    if (sector_addr != _addr) {
-      SPICACHE_LOG(sector_addr);
-      this->sync(fl);
-      _addr = sector_addr;
+    int idx = find(sector_addr);
+
+    // Whole sector is overwritten: no need to load it, erase and program
+    // directly from source. Cached copy (if any) is outdated.
+    if (wr_bytes == SFLASH_SECTOR_SIZE) {
+      STATS_INC(write_misses);
+
+      if (idx >= 0) {
+        _line[idx].addr = INVALID_ADDR;
+        _line[idx].dirty = 0;
+      }
 
-      // read a whole page from flash
-      fl->readBuffer(sector_addr, _buf, SFLASH_SECTOR_SIZE);
+      if (sectors != SECTOR_ERASED &&
+          !fl->eraseSector(sector_addr / SFLASH_SECTOR_SIZE)) {
+        return false;
+      }
+      if (fl->writeBuffer(sector_addr, src8, SFLASH_SECTOR_SIZE, true) !=
+          SFLASH_SECTOR_SIZE) {
+        return false;
+      }
+
+      src8 += wr_bytes;
+      remain -= wr_bytes;
+      address += wr_bytes;
+      continue;
     }
 
-    memcpy(_buf + offset, src8, wr_bytes);
+    // Flash sector is not cached, flush least recently used line and load
+    // the new sector into it
+    if (idx < 0) {
+      STATS_INC(write_misses);
+      idx = victim();
+      SPICACHE_LOG(_line[idx].addr, sector_addr);
+
+      this->flush(fl, idx);
+      _line[idx].addr = sector_addr;
+      _line[idx].used = ++_tick;
+      _line[idx].blank = (sectors == SECTOR_ERASED);
+
+      // read a whole sector from flash, unless its contents are not needed
+      if (sectors == SECTOR_USED) {
+        fl->readBuffer(sector_addr, line_buf(idx), SFLASH_SECTOR_SIZE);
+      } else {
+        memset(line_buf(idx), 0xff, SFLASH_SECTOR_SIZE);
+      }
+    } else {
+      STATS_INC(write_hits);
+    }
+
+    // Copy page by page, only pages whose content changes are marked dirty
+    uint8_t *dst = line_buf(idx) + offset;
+    uint32_t pos = offset;
+    while (pos < offset + wr_bytes) {
+      uint32_t const pg = pos / SFLASH_PAGE_SIZE;
+      uint32_t n = (pg + 1) * SFLASH_PAGE_SIZE - pos;
+      n = min(offset + wr_bytes - pos, n);
+
+      if (memcmp(dst, src8 + (pos - offset), n)) {
+        memcpy(dst, src8 + (pos - offset), n);
+        _line[idx].dirty |= (uint16_t)(1u << pg);
+      }
+
+      dst += n;
+      pos += n;
+    }
 
     // adjust for next run
     src8 += wr_bytes;
@@ -99,37 +304,63 @@ bool Adafruit_FlashCache::write(Adafruit_SPIFlashBase *fl, uint32_t address,
 
 bool Adafruit_FlashCache::read(Adafruit_SPIFlashBase *fl, uint32_t address,
                                uint8_t *buffer, uint32_t count) {
-  // overwrite with cache value if available
-  if ((_addr != INVALID_ADDR) &&
-      !(address < _addr && address + count <= _addr) &&
-      !(address >= _addr + SFLASH_SECTOR_SIZE)) {
-    int32_t dst_off = _addr - address;
-    int32_t src_off = 0;
-
-    if (dst_off < 0) {
-      src_off = -dst_off;
-      dst_off = 0;
-    }
+  // Copy cached sectors, consecutive uncached ones are one segment. Segments
+  // are read from flash together.
+  FlashIoVec iov[READ_SEGMENTS];
+  uint8_t segments = 0;
+
+  FlashIoVec uncached = {address, buffer, 0};
+
+  while (count) {
+    uint32_t const offset = offset_of(address);
 
-    int32_t cache_bytes = min((int32_t)(SFLASH_SECTOR_SIZE - src_off),
-                              (int32_t)(count - dst_off));
+    uint32_t rd_bytes = SFLASH_SECTOR_SIZE - offset;
+    rd_bytes = min(count, rd_bytes);
 
-    // start to cached
-    if (dst_off) {
-      fl->readBuffer(address, buffer, dst_off);
+    int const idx = find(sector_of(address));
+
+    if (idx < 0) {
+      STATS_INC(read_misses);
+      uncached.len += rd_bytes;
+    } else {
+      STATS_INC(read_hits);
+      if (uncached.len) {
+        if (segments == READ_SEGMENTS) {
+          fl->readBufferV(iov, segments);
+          segments = 0;
+        }
+        iov[segments++] = uncached;
+      }
+
+      memcpy(buffer, line_buf(idx) + offset, rd_bytes);
+
+      uncached.addr = address + rd_bytes;
+      uncached.buf = buffer + rd_bytes;
+      uncached.len = 0;
     }
 
-    // cached
-    memcpy(buffer + dst_off, _buf + src_off, cache_bytes);
+    buffer += rd_bytes;
+    address += rd_bytes;
+    count -= rd_bytes;
+  }
 
-    // cached to end
-    uint32_t copied = (uint32_t)(dst_off + cache_bytes);
-    if (copied < count) {
-      fl->readBuffer(address + copied, buffer + copied, count - copied);
+  if (uncached.len) {
+    if (segments == READ_SEGMENTS) {
+      fl->readBufferV(iov, segments);
+      segments = 0;
     }
-  } else {
-    fl->readBuffer(address, buffer, count);
+    iov[segments++] = uncached;
+  }
+
+  if (segments) {
+    fl->readBufferV(iov, segments);
   }
 
   return true;
 }
+
+#if SPIFLASH_STATS
+void Adafruit_FlashCache::resetStats(void) {
+  memset(&_stats, 0, sizeof(_stats));
+}
+#endif
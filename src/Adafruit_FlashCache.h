@@ -29,21 +29,89 @@
 #include <stdint.h>
 
 // forward declaration
-class Adafruit_SPIFlashBase;
+class Adafruit_FlashTransport;
+template <class Transport> class Adafruit_SPIFlashBaseT;
+typedef Adafruit_SPIFlashBaseT<Adafruit_FlashTransport> Adafruit_SPIFlashBase;
 
+// see Adafruit_SPIFlashBase.h
+#ifndef SPIFLASH_STATS
+#define SPIFLASH_STATS 0
+#endif
+
+#if SPIFLASH_STATS
+// Sectors accessed by read() and write(). Whole sector writes bypass the cache
+// and count as misses.
+typedef struct {
+  uint32_t read_hits;
+  uint32_t read_misses;
+  uint32_t write_hits;
+  uint32_t write_misses;
+  uint32_t flushes;      // dirty lines written back
+  uint32_t flush_erases; // ... that needed an erase, others are only programmed
+} SPIFlash_CacheStats_t;
+#endif
+
+// Write-back cache of flash sectors (4 KB each). Multiple lines are evicted in
+// least recently used order so that FAT, directory and data sectors can be
+// modified alternately without erasing and programming on every switch.
 class Adafruit_FlashCache {
 private:
-  uint8_t _buf[4096] __attribute__((aligned(4))); // must be sector size
-  uint32_t _addr;
+  typedef struct {
+    uint32_t addr; // sector address, INVALID_ADDR if unused
+    uint32_t used; // tick of last access for LRU
+    uint16_t dirty; // bitmask of pages modified since loaded or last sync
+    bool blank;     // flash sector is erased, dirty pages need no check
+  } cache_line_t;
+
+  uint8_t _count;
+  uint32_t _tick;
+  uint8_t *_buf; // _count * sector size, must be 4-byte aligned
+  cache_line_t *_line;
+
+  uint8_t *line_buf(uint8_t idx) { return _buf + idx * 4096UL; }
+  int find(uint32_t sector_addr);
+  uint8_t victim(void);
+  bool flush(Adafruit_SPIFlashBase *fl, uint8_t idx);
+  bool programmable(Adafruit_SPIFlashBase *fl, uint8_t idx);
+
+#if SPIFLASH_STATS
+  SPIFlash_CacheStats_t _stats;
+#endif
 
 public:
-  Adafruit_FlashCache(void);
+  Adafruit_FlashCache(uint8_t lines = 1);
+  ~Adafruit_FlashCache();
+
+  // Number of cache lines, 0 if memory allocation failed. write() then fails,
+  // read() reads from flash and sync() has nothing to do.
+  uint8_t lineCount(void) { return _count; }
 
+  // Write all dirty lines to flash. Lines are kept as clean copies. Sectors
+  // whose changes only clear bits (e.g appending to erased space) are updated
+  // by programming the modified pages, without erasing.
   bool sync(Adafruit_SPIFlashBase *fl);
+
+  // Flush and drop lines overlapping with the address range. Required before
+  // flash contents are modified without going through the cache.
+  bool evict(Adafruit_SPIFlashBase *fl, uint32_t addr, uint32_t len);
+
+  // Drop lines overlapping with the address range without writing them back,
+  // their contents are not needed anymore.
+  void drop(uint32_t addr, uint32_t len);
+
+  // What the flash sectors of a write() hold, if known. Sectors whose
+  // contents are not needed anymore are not read, erased ones not erased.
+  enum { SECTOR_USED, SECTOR_DISCARDED, SECTOR_ERASED };
+
   bool write(Adafruit_SPIFlashBase *fl, uint32_t dst, void const *src,
-             uint32_t len);
+             uint32_t len, uint8_t sectors = SECTOR_USED);
   bool read(Adafruit_SPIFlashBase *fl, uint32_t addr, uint8_t *dst,
             uint32_t count);
+
+#if SPIFLASH_STATS
+  SPIFlash_CacheStats_t const *getStats(void) { return &_stats; }
+  void resetStats(void);
+#endif
 };
 
 #endif /* ADAFRUIT_FLASHCACHE_H_ */
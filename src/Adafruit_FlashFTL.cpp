@@ -0,0 +1,465 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_FlashFTL.h"
+
+#define FTL_MAGIC 0x46544C31 // "FTL1"
+
+// Slots per flash sector, the first 512 bytes hold the header
+#define FTL_SLOTS 7
+#define FTL_SLOT_SIZE 512
+
+#define FTL_NO_SLOT 0xffff
+#define FTL_NO_SECTOR 0xffffffff
+#define FTL_ERASED 0xff // _state of a free sector known to be erased
+
+// Runs of slots adjacent in flash gathered into one vectored read
+#define FTL_READ_SEGMENTS 4
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t seq_inv; // ~seq, detects an interrupted header write
+  uint32_t lba[FTL_SLOTS];
+} ftl_header_t;
+
+// Logical sector with its complement: neither an unwritten (0xffffffff) nor a
+// partially written entry is valid.
+static inline uint32_t lba_entry(uint32_t lba) {
+  return (lba & 0xffff) | ((~lba & 0xffff) << 16);
+}
+
+static inline uint32_t lba_of(uint32_t entry) {
+  return ((entry >> 16) == (~entry & 0xffff)) ? (entry & 0xffff) : 0xffffffff;
+}
+
+Adafruit_FlashFTL::Adafruit_FlashFTL(Adafruit_SPIFlashBase *flash) {
+  _flash = flash;
+  _addr = 0;
+  _sectors = _spare = _lba_count = 0;
+  _map = NULL;
+  _state = NULL;
+  _free = 0;
+  _open = FTL_NO_SECTOR;
+  _open_slot = FTL_SLOTS;
+  _seq = 0;
+  _alloc = 0;
+}
+
+Adafruit_FlashFTL::~Adafruit_FlashFTL() { end(); }
+
+bool Adafruit_FlashFTL::begin(uint32_t address, uint32_t len) {
+  end();
+
+  uint32_t const flash_size = _flash->size();
+  if (len == 0 && address < flash_size) {
+    len = flash_size - address;
+  }
+
+  if (((address | len) & (SFLASH_SECTOR_SIZE - 1)) || len > flash_size ||
+      address > flash_size - len) {
+    return false;
+  }
+
+  // slot numbers must fit in the map
+  _sectors = min(len / SFLASH_SECTOR_SIZE, (uint32_t)FTL_NO_SLOT / FTL_SLOTS);
+  _spare = _sectors / 16 + 2;
+  if (_sectors <= _spare) {
+    return false;
+  }
+
+  _addr = address;
+  _lba_count = (_sectors - _spare) * FTL_SLOTS;
+  _map = (uint16_t *)malloc(_lba_count * sizeof(uint16_t));
+  _state = (uint8_t *)malloc(_sectors);
+
+  if (!_map || !_state) {
+    end();
+    return false;
+  }
+
+  return mount();
+}
+
+void Adafruit_FlashFTL::end(void) {
+  if (_map) {
+    _flash->waitUntilReady();
+  }
+
+  free(_map);
+  free(_state);
+  _map = NULL;
+  _state = NULL;
+  _lba_count = 0;
+  _open = FTL_NO_SECTOR;
+  _open_slot = FTL_SLOTS;
+}
+
+uint32_t Adafruit_FlashFTL::slotAddr(uint32_t slot) {
+  return sectorAddr(slot / FTL_SLOTS) + (slot % FTL_SLOTS + 1) * FTL_SLOT_SIZE;
+}
+
+// Rebuild mapping and sector states from the headers
+bool Adafruit_FlashFTL::mount(void) {
+  memset(_map, 0xff, _lba_count * sizeof(uint16_t));
+  memset(_state, 0, _sectors);
+  _seq = 0;
+  _alloc = 0;
+
+  for (uint32_t s = 0; s < _sectors; s++) {
+    ftl_header_t hdr;
+    if (!_flash->readBuffer(sectorAddr(s), (uint8_t *)&hdr, sizeof(hdr))) {
+      return false;
+    }
+
+    // Free, also if the header looks erased: an erase may have been
+    // interrupted, it is erased again before use.
+    if (hdr.magic != FTL_MAGIC || hdr.seq != ~hdr.seq_inv) {
+      continue;
+    }
+
+    if (hdr.seq >= _seq) {
+      _seq = hdr.seq;
+      _alloc = s;
+    }
+
+    for (uint32_t i = 0; i < FTL_SLOTS; i++) {
+      uint32_t const lba = lba_of(hdr.lba[i]);
+      uint32_t const slot = s * FTL_SLOTS + i;
+
+      if (lba < _lba_count &&
+          (_map[lba] == FTL_NO_SLOT || isNewer(slot, _map[lba]))) {
+        _map[lba] = slot;
+      }
+    }
+  }
+
+  for (uint32_t lba = 0; lba < _lba_count; lba++) {
+    if (_map[lba] != FTL_NO_SLOT) {
+      _state[_map[lba] / FTL_SLOTS]++;
+    }
+  }
+
+  _free = 0;
+  for (uint32_t s = 0; s < _sectors; s++) {
+    if (_state[s] == 0) {
+      _free++;
+    }
+  }
+
+  // never append to a sector written before: a slot may have been partially
+  // programmed by an interrupted write
+  _open = FTL_NO_SECTOR;
+  _open_slot = FTL_SLOTS;
+
+  return true;
+}
+
+// Slots of a sector are filled in order, sectors in sequence number order
+bool Adafruit_FlashFTL::isNewer(uint32_t slot, uint32_t other) {
+  uint32_t const sector = slot / FTL_SLOTS;
+  uint32_t const other_sector = other / FTL_SLOTS;
+
+  if (sector == other_sector) {
+    return slot > other;
+  }
+
+  uint32_t seq, other_seq;
+  _flash->readBuffer(sectorAddr(sector) + offsetof(ftl_header_t, seq),
+                     (uint8_t *)&seq, sizeof(seq));
+  _flash->readBuffer(sectorAddr(other_sector) + offsetof(ftl_header_t, seq),
+                     (uint8_t *)&other_seq, sizeof(other_seq));
+
+  return seq > other_seq;
+}
+
+// Open a free sector to append to, preferably one already erased
+bool Adafruit_FlashFTL::openSector(void) {
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    for (uint32_t n = 1; n <= _sectors; n++) {
+      uint32_t const s = (_alloc + n) % _sectors;
+
+      if (s == _open || (pass == 0 && _state[s] != FTL_ERASED) ||
+          (pass == 1 && _state[s] != 0)) {
+        continue;
+      }
+
+      if (_state[s] != FTL_ERASED &&
+          !_flash->eraseSector(sectorAddr(s) / SFLASH_SECTOR_SIZE)) {
+        return false;
+      }
+
+      // current sector becomes free if all its slots were rewritten since
+      if (_open != FTL_NO_SECTOR && _state[_open] == 0) {
+        _free++;
+      }
+      _free--;
+
+      _seq++;
+      ftl_header_t hdr;
+      memset(&hdr, 0xff, sizeof(hdr));
+      hdr.magic = FTL_MAGIC;
+      hdr.seq = _seq;
+      hdr.seq_inv = ~_seq;
+
+      _state[s] = 0;
+      _open = s;
+      _open_slot = 0;
+      _alloc = s;
+
+      return _flash->writeBuffer(sectorAddr(s), (uint8_t const *)&hdr,
+                                 offsetof(ftl_header_t, lba)) ==
+             offsetof(ftl_header_t, lba);
+    }
+  }
+
+  return false;
+}
+
+// Make sure the open sector has a free slot. Writes keep one free sector in
+// reserve for collect() to move live slots to, reserve = true may use it.
+bool Adafruit_FlashFTL::allocSlot(bool reserve) {
+  while (_open == FTL_NO_SECTOR || _open_slot == FTL_SLOTS) {
+    if (reserve || _free >= 2) {
+      return openSector();
+    }
+
+    if (!collect()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Write count logical sectors to the next slots of the open sector, data
+// first then their header entries
+bool Adafruit_FlashFTL::program(uint32_t lba, uint8_t const *src,
+                                uint32_t count) {
+  uint32_t const first = _open * FTL_SLOTS + _open_slot;
+  uint32_t entry[FTL_SLOTS];
+
+  for (uint32_t i = 0; i < count; i++) {
+    entry[i] = lba_entry(lba + i);
+  }
+
+  // slots are used even if programming fails
+  _open_slot += count;
+
+  uint32_t const len = count * FTL_SLOT_SIZE;
+  uint32_t const entry_addr = sectorAddr(_open) + offsetof(ftl_header_t, lba) +
+                              (first % FTL_SLOTS) * sizeof(uint32_t);
+
+  if (_flash->writeBuffer(slotAddr(first), src, len) != len ||
+      _flash->writeBuffer(entry_addr, (uint8_t const *)entry,
+                          count * sizeof(uint32_t)) !=
+          count * sizeof(uint32_t)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    release(_map[lba + i]);
+    _map[lba + i] = first + i;
+    _state[_open]++;
+  }
+
+  return true;
+}
+
+// Slot holds an outdated copy
+void Adafruit_FlashFTL::release(uint32_t slot) {
+  if (slot == FTL_NO_SLOT) {
+    return;
+  }
+
+  uint32_t const s = slot / FTL_SLOTS;
+  _state[s]--;
+
+  if (_state[s] == 0 && s != _open) {
+    _free++;
+  }
+}
+
+// Move live slots of the sector with the fewest of them to the open sector,
+// it is then free. Return false if all sectors are full of live slots.
+bool Adafruit_FlashFTL::collect(void) {
+  uint32_t victim = FTL_NO_SECTOR;
+  uint8_t fewest = FTL_SLOTS;
+
+  for (uint32_t s = 0; s < _sectors; s++) {
+    if (s != _open && _state[s] != FTL_ERASED && _state[s] > 0 &&
+        _state[s] < fewest) {
+      victim = s;
+      fewest = _state[s];
+    }
+  }
+
+  if (victim == FTL_NO_SECTOR) {
+    return false;
+  }
+
+  ftl_header_t hdr;
+  if (!_flash->readBuffer(sectorAddr(victim), (uint8_t *)&hdr, sizeof(hdr))) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < FTL_SLOTS && _state[victim]; i++) {
+    uint32_t const lba = lba_of(hdr.lba[i]);
+    uint32_t const slot = victim * FTL_SLOTS + i;
+
+    if (lba >= _lba_count || _map[lba] != slot) {
+      continue;
+    }
+
+    if (!_flash->readBuffer(slotAddr(slot), _buf, FTL_SLOT_SIZE) ||
+        !allocSlot(true) || !program(lba, _buf, 1)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Adafruit_FlashFTL::background(void) {
+  if (!_map) {
+    return false;
+  }
+
+  // erase started by the previous call is still in progress
+  if (!_flash->poll()) {
+    return true;
+  }
+
+  // keep spare sectors free so that writes do not wait for collection
+  if (_free < _spare && collect()) {
+    return true;
+  }
+
+  for (uint32_t n = 1; n <= _sectors; n++) {
+    uint32_t const s = (_alloc + n) % _sectors;
+
+    if (s != _open && _state[s] == 0) {
+      if (_flash->startEraseSector(sectorAddr(s) / SFLASH_SECTOR_SIZE)) {
+        _state[s] = FTL_ERASED;
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//--------------------------------------------------------------------+
+// SdFat BaseBlockDRiver API
+// A block is 512 bytes
+//--------------------------------------------------------------------+
+
+bool Adafruit_FlashFTL::isBusy() { return !_flash->isReady(); }
+
+uint32_t Adafruit_FlashFTL::sectorCount() { return _lba_count; }
+
+// Slots are programmed right away, only wait for the last program
+bool Adafruit_FlashFTL::syncDevice() {
+  _flash->waitUntilReady();
+  return true;
+}
+
+bool Adafruit_FlashFTL::readSector(uint32_t block, uint8_t *dst) {
+  return readSectors(block, dst, 1);
+}
+
+bool Adafruit_FlashFTL::readSectors(uint32_t block, uint8_t *dst, size_t ns) {
+  if (!_map || block > _lba_count || ns > _lba_count - block) {
+    return false;
+  }
+
+  FlashIoVec iov[FTL_READ_SEGMENTS];
+  uint8_t segments = 0;
+
+  for (size_t i = 0; i < ns; i++, dst += FTL_SLOT_SIZE) {
+    uint32_t const slot = _map[block + i];
+
+    // never written
+    if (slot == FTL_NO_SLOT) {
+      memset(dst, 0xff, FTL_SLOT_SIZE);
+      continue;
+    }
+
+    uint32_t const addr = slotAddr(slot);
+
+    // continues the previous run
+    if (segments) {
+      FlashIoVec *last = &iov[segments - 1];
+
+      if (last->addr + last->len == addr && last->buf + last->len == dst) {
+        last->len += FTL_SLOT_SIZE;
+        continue;
+      }
+    }
+
+    if (segments == FTL_READ_SEGMENTS) {
+      if (!_flash->readBufferV(iov, segments)) {
+        return false;
+      }
+      segments = 0;
+    }
+
+    iov[segments].addr = addr;
+    iov[segments].buf = dst;
+    iov[segments].len = FTL_SLOT_SIZE;
+    segments++;
+  }
+
+  return !segments || _flash->readBufferV(iov, segments);
+}
+
+bool Adafruit_FlashFTL::writeSector(uint32_t block, const uint8_t *src) {
+  return writeSectors(block, src, 1);
+}
+
+bool Adafruit_FlashFTL::writeSectors(uint32_t block, const uint8_t *src,
+                                     size_t ns) {
+  if (!_map || block > _lba_count || ns > _lba_count - block) {
+    return false;
+  }
+
+  // consecutive sectors fill the open sector together
+  while (ns) {
+    if (!allocSlot(false)) {
+      return false;
+    }
+
+    uint32_t const count =
+        min((uint32_t)ns, (uint32_t)(FTL_SLOTS - _open_slot));
+    if (!program(block, src, count)) {
+      return false;
+    }
+
+    block += count;
+    src += count * FTL_SLOT_SIZE;
+    ns -= count;
+  }
+
+  return true;
+}
@@ -0,0 +1,124 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ADAFRUIT_FLASHFTL_H_
+#define ADAFRUIT_FLASHFTL_H_
+
+#include "Adafruit_SPIFlash.h"
+
+// Wear leveling block device for a FAT volume. Logical 512-byte sectors are
+// appended to pre-erased flash instead of being rewritten in place: a FAT
+// sector written over and over moves across the whole region, and rewriting
+// it costs a page program instead of a sector erase. Flash sectors holding
+// mostly outdated copies are garbage collected (live copies moved, then
+// erased) when free space runs low, or ahead of time by background().
+//
+// Each 4 KB flash sector holds a header and 7 slots. The header has the
+// sequence number of the sector and the logical sector of each slot, written
+// after the slot data. begin() rebuilds the mapping from the headers, the
+// newest copy of each logical sector wins, so an interrupted write leaves the
+// previous data. About 82% of the region is usable.
+//
+// Takes 2 bytes of RAM per logical sector and 1 byte per flash sector. Flash
+// is accessed directly: use an Adafruit_SPIFlashBase, or Adafruit_SPIFlash
+// without cache, and do not access the region otherwise.
+class Adafruit_FlashFTL : public FsBlockDeviceInterface {
+public:
+  Adafruit_FlashFTL(Adafruit_SPIFlashBase *flash);
+  ~Adafruit_FlashFTL();
+
+  // Use len bytes at address, both sector aligned, len = 0 up to the end of
+  // flash. Flash must be started. Return false if the region is too small or
+  // memory allocation fails.
+  bool begin(uint32_t address = 0, uint32_t len = 0);
+  void end(void);
+
+  // Garbage collect or start erasing a free flash sector ahead of writes,
+  // e.g from loop() when idle. Return false if there is nothing left to do.
+  bool background(void);
+
+  //------------- SdFat v2 FsBlockDeviceInterface API -------------//
+  virtual bool isBusy();
+  virtual uint32_t sectorCount();
+  virtual bool syncDevice();
+
+  virtual bool readSector(uint32_t block, uint8_t *dst);
+  virtual bool readSectors(uint32_t block, uint8_t *dst, size_t ns);
+  virtual bool writeSector(uint32_t block, const uint8_t *src);
+  virtual bool writeSectors(uint32_t block, const uint8_t *src, size_t ns);
+
+  // SdFat v1 BaseBlockDRiver API for backward-compatible
+  virtual bool syncBlocks() { return syncDevice(); }
+
+  virtual bool readBlock(uint32_t block, uint8_t *dst) {
+    return readSector(block, dst);
+  }
+
+  virtual bool readBlocks(uint32_t block, uint8_t *dst, size_t nb) {
+    return readSectors(block, dst, nb);
+  }
+
+  virtual bool writeBlock(uint32_t block, const uint8_t *src) {
+    return writeSector(block, src);
+  }
+
+  virtual bool writeBlocks(uint32_t block, const uint8_t *src, size_t nb) {
+    return writeSectors(block, src, nb);
+  }
+
+protected:
+  Adafruit_SPIFlashBase *_flash;
+
+  uint32_t _addr;
+  uint32_t _sectors; // flash sectors in the region
+  uint32_t _spare;   // flash sectors not backing logical sectors
+  uint32_t _lba_count;
+
+  uint16_t *_map;  // slot of each logical sector
+  uint8_t *_state; // live slots of each flash sector, or erased
+
+  uint32_t _free;     // flash sectors without live slots, except the open one
+  uint32_t _open;     // flash sector being filled
+  uint8_t _open_slot; // next slot to fill in it
+  uint32_t _seq;      // sequence number of the open sector
+  uint32_t _alloc;    // last opened sector, free ones are used round robin
+
+  uint8_t _buf[512];
+
+  uint32_t sectorAddr(uint32_t sector) {
+    return _addr + sector * SFLASH_SECTOR_SIZE;
+  }
+  uint32_t slotAddr(uint32_t slot);
+
+  bool mount(void);
+  bool isNewer(uint32_t slot, uint32_t other);
+
+  bool openSector(void);
+  bool allocSlot(bool reserve);
+  bool program(uint32_t lba, uint8_t const *src, uint32_t count);
+  void release(uint32_t slot);
+  bool collect(void);
+};
+
+#endif /* ADAFRUIT_FLASHFTL_H_ */
@@ -26,14 +26,22 @@
 #define ADAFRUIT_FLASHTRANSPORT_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "flash_devices.h"
+
 enum {
-  SFLASH_CMD_READ = 0x03,      // Single Read
-  SFLASH_CMD_FAST_READ = 0x0B, // Fast Read
-  SFLASH_CMD_QUAD_READ = 0x6B, // 1 line address, 4 line data
+  SFLASH_CMD_READ = 0x03,         // Single Read
+  SFLASH_CMD_FAST_READ = 0x0B,    // Fast Read
+  SFLASH_CMD_QUAD_READ = 0x6B,    // 1 line address, 4 line data
+  SFLASH_CMD_QUAD_IO_READ = 0xEB, // 4 line address, mode and data
+
+  // Sent on a single line, resets continuous read mode of 0xEB
+  SFLASH_CMD_CONTINUOUS_READ_RESET = 0xFF,
 
   SFLASH_CMD_READ_JEDEC_ID = 0x9f,
+  SFLASH_CMD_READ_SFDP = 0x5A, // 3 address bytes, 8 dummy cycles
 
   SFLASH_CMD_PAGE_PROGRAM = 0x02,
   SFLASH_CMD_QUAD_PAGE_PROGRAM = 0x32, // 1 line address, 4 line data
@@ -52,20 +60,53 @@ enum {
 
   SFLASH_CMD_ERASE_PAGE = 0x81,
   SFLASH_CMD_ERASE_SECTOR = 0x20,
+  SFLASH_CMD_ERASE_BLOCK32 = 0x52,
   SFLASH_CMD_ERASE_BLOCK = 0xD8,
   SFLASH_CMD_ERASE_CHIP = 0xC7,
 
+  SFLASH_CMD_SUSPEND = 0x75, // erase/program suspend
+  SFLASH_CMD_RESUME = 0x7A,  // erase/program resume
+
   SFLASH_CMD_4_BYTE_ADDR = 0xB7,
   SFLASH_CMD_3_BYTE_ADDR = 0xE9,
+
+  SFLASH_CMD_POWER_DOWN = 0xB9,         // Deep Power-Down
+  SFLASH_CMD_RELEASE_POWER_DOWN = 0xAB, // Release from Deep Power-Down
+
+  // QPI (4-4-4) mode, exit commands are sent on 4 lines
+  SFLASH_CMD_ENTER_QPI = 0x38, // Winbond
+  SFLASH_CMD_EXIT_QPI = 0xFF,
+  SFLASH_CMD_ENTER_QPI_MX = 0x35, // Macronix
+  SFLASH_CMD_EXIT_QPI_MX = 0xF5,
+  SFLASH_CMD_SET_READ_PARAMS = 0xC0, // Winbond QPI dummy cycles
+
+  // Commands with 4-byte address regardless of address mode. There is no 32K
+  // block erase variant on most devices.
+  SFLASH_CMD_READ_4B = 0x13,
+  SFLASH_CMD_FAST_READ_4B = 0x0C,
+  SFLASH_CMD_QUAD_READ_4B = 0x6C,
+  SFLASH_CMD_QUAD_IO_READ_4B = 0xEC,
+  SFLASH_CMD_PAGE_PROGRAM_4B = 0x12,
+  SFLASH_CMD_QUAD_PAGE_PROGRAM_4B = 0x34,
+  SFLASH_CMD_ERASE_SECTOR_4B = 0x21,
+  SFLASH_CMD_ERASE_BLOCK_4B = 0xDC,
 };
 
 /// Constant that is (mostly) true to all external flash devices
 enum {
   SFLASH_BLOCK_SIZE = 64 * 1024UL,
+  SFLASH_BLOCK32_SIZE = 32 * 1024UL,
   SFLASH_SECTOR_SIZE = 4 * 1024,
   SFLASH_PAGE_SIZE = 256,
 };
 
+// One segment of a vectored read
+typedef struct {
+  uint32_t addr;
+  uint8_t *buf;
+  uint32_t len;
+} FlashIoVec;
+
 class Adafruit_FlashTransport {
 public:
   virtual void begin(void) = 0;
@@ -73,6 +114,25 @@ public:
 
   virtual bool supportQuadMode(void) = 0;
 
+  /// Transport sends the 4-byte address opcodes (e.g 0x13, 0x12, 0x21) when
+  /// address length is 4. Otherwise device is switched to 4-byte address mode
+  /// with 0xB7, which is lost on reset.
+  virtual bool support4ByteOpcodes(void) { return false; }
+
+  /// Transport can send opcode and address on 4 lines as well (QPI, 4-4-4)
+  virtual bool supportQpiMode(void) { return false; }
+
+  /// Transport implements writeMemoryWhenReady()
+  virtual bool supportPipelinedWrite(void) { return false; }
+
+  /// Device can be put in deep power-down, false if e.g it also holds the
+  /// running code
+  virtual bool supportPowerDown(void) { return false; }
+
+  /// Flash device already detected and configured by the core (e.g ESP32 and
+  /// RP2040 internal flash), NULL if it has to be detected by begin()
+  virtual SPIFlash_Device_t *getFlashDevice(void) { return NULL; }
+
   /// Set clock speed in hertz
   /// @param write_hz Write clock speed in hertz
   /// @param read_hz  Read  clock speed in hertz
@@ -100,7 +160,8 @@ public:
                             uint32_t len) = 0;
 
   /// Erase external flash by address
-  /// @param command  can be sector erase (0x20) or block erase 0xD8
+  /// @param command  can be sector erase (0x20), 32K block erase (0x52) or
+  ///                 block erase 0xD8
   /// @param address  address to be erased
   /// @return true if success
   virtual bool eraseCommand(uint8_t command, uint32_t address) = 0;
@@ -113,6 +174,20 @@ public:
   /// @return true if success
   virtual bool readMemory(uint32_t addr, uint8_t *buffer, uint32_t len) = 0;
 
+  /// Read scattered segments of external flash contents. Transports can
+  /// override it to set up the bus once for all segments.
+  /// @param iov        segments to read
+  /// @param count      number of segments
+  /// @return true if success
+  virtual bool readMemoryV(FlashIoVec const *iov, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      if (!readMemory(iov[i].addr, iov[i].buf, iov[i].len)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   /// Write data to external flash contents, flash sector must be previously
   /// erased first. Typically it uses quad write command 0x32
   /// @param addr       address to read
@@ -122,18 +197,99 @@ public:
   virtual bool writeMemory(uint32_t addr, uint8_t const *data,
                            uint32_t len) = 0;
 
+  /// Wait for the program in progress to complete, then Write Enable and
+  /// writeMemory() right away. Used for back to back page programs: status is
+  /// polled without a transaction per poll, so that the next page goes out as
+  /// soon as WIP clears. Fails if the device stays busy for too long.
+  /// @param addr       address to write
+  /// @param data       writing data
+  /// @param len        number of byte to write
+  /// @return true if success
+  virtual bool writeMemoryWhenReady(uint32_t addr, uint8_t const *data,
+                                    uint32_t len) {
+    (void)addr;
+    (void)data;
+    (void)len;
+    return false;
+  }
+
+  /// Read Serial Flash Discoverable Parameters (JESD216) with command 0x5A.
+  /// @param addr       SFDP address
+  /// @param data       buffer to hold data
+  /// @param len        number of byte to read
+  /// @return true if success, false if not supported by transport
+  virtual bool readSFDP(uint32_t addr, uint8_t *data, uint32_t len) {
+    (void)addr;
+    (void)data;
+    (void)len;
+    return false;
+  }
+
+  /// Map external flash into the CPU address space (execute-in-place) so that
+  /// it can be read in place without copying. Data written or erased by this
+  /// transport is visible through the mapping once the operation completes.
+  /// @param addr       address to map
+  /// @param len        number of byte to map
+  /// @return pointer to flash contents at addr, NULL if not supported
+  virtual const uint8_t *map(uint32_t addr, uint32_t len) {
+    (void)addr;
+    (void)len;
+    return NULL;
+  }
+
   void setAddressLength(uint8_t addr_len) { _addr_len = addr_len; }
   void setReadCommand(uint8_t cmd_read) { _cmd_read = cmd_read; }
 
+  // Keep device in continuous read mode between 0xEB reads, only honored by
+  // transports that can skip the opcode
+  void setContinuousRead(bool enabled) { _cont_read = enabled; }
+
+  // Device entered or left QPI mode, all commands are then sent on 4 lines
+  void setQpiMode(bool enabled) { _qpi = enabled; }
+  bool qpiMode(void) { return _qpi; }
+
 protected:
   // Number of bytes for address
   uint8_t _addr_len;
 
+  // 4-byte address variant of a read/program/erase command if address length
+  // is 4, command itself otherwise
+  uint8_t addressCommand(uint8_t command) {
+    if (_addr_len < 4) {
+      return command;
+    }
+
+    switch (command) {
+    case SFLASH_CMD_READ:
+      return SFLASH_CMD_READ_4B;
+    case SFLASH_CMD_FAST_READ:
+      return SFLASH_CMD_FAST_READ_4B;
+    case SFLASH_CMD_QUAD_READ:
+      return SFLASH_CMD_QUAD_READ_4B;
+    case SFLASH_CMD_QUAD_IO_READ:
+      return SFLASH_CMD_QUAD_IO_READ_4B;
+    case SFLASH_CMD_PAGE_PROGRAM:
+      return SFLASH_CMD_PAGE_PROGRAM_4B;
+    case SFLASH_CMD_QUAD_PAGE_PROGRAM:
+      return SFLASH_CMD_QUAD_PAGE_PROGRAM_4B;
+    case SFLASH_CMD_ERASE_SECTOR:
+      return SFLASH_CMD_ERASE_SECTOR_4B;
+    case SFLASH_CMD_ERASE_BLOCK:
+      return SFLASH_CMD_ERASE_BLOCK_4B;
+    default:
+      return command;
+    }
+  }
+
   // Command use for read operation
   uint8_t _cmd_read;
+
+  bool _cont_read;
+  bool _qpi;
 };
 
 #include "qspi/Adafruit_FlashTransport_QSPI.h"
+#include "sim/Adafruit_FlashTransport_Sim.h"
 #include "spi/Adafruit_FlashTransport_SPI.h"
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -29,6 +29,7 @@
 #endif
 
 #define LOGICAL_BLOCK_SIZE 512
+#define BLOCKS_PER_SECTOR (SFLASH_SECTOR_SIZE / LOGICAL_BLOCK_SIZE)
 
 #if SPIFLASH_DEBUG
 #define SPIFLASH_LOG(_block, _count)                                           \
@@ -48,32 +49,52 @@
 
 Adafruit_SPIFlash::Adafruit_SPIFlash() : Adafruit_SPIFlashBase() {
   _cache_en = true;
+  _cache_lines = 1;
   _cache = NULL;
+  _discard = NULL;
 }
 
 Adafruit_SPIFlash::Adafruit_SPIFlash(Adafruit_FlashTransport *transport,
-                                     bool useCache)
+                                     bool useCache, uint8_t cacheLines)
     : Adafruit_SPIFlashBase(transport) {
-  _cache_en = useCache;
+  _cache_en = useCache && (cacheLines > 0);
+  _cache_lines = cacheLines;
   _cache = NULL;
+  _discard = NULL;
 }
 
 bool Adafruit_SPIFlash::begin(SPIFlash_Device_t const *flash_devs,
                               size_t count) {
   bool ret = Adafruit_SPIFlashBase::begin(flash_devs, count);
+  initCache();
+  return ret;
+}
+
+bool Adafruit_SPIFlash::beginWarm(SPIFlash_State_t *state,
+                                  SPIFlash_Device_t const *flash_devs,
+                                  size_t count) {
+  bool ret = Adafruit_SPIFlashBase::beginWarm(state, flash_devs, count);
+  initCache();
+  return ret;
+}
 
+void Adafruit_SPIFlash::initCache(void) {
 #ifndef __AVR__
   // Use cache if not FRAM
   // Note: Skip caching if AVR. Comment out since new cache on AVR seems to
   // corrupt memory rather than safely return NULL
-  if (_flash_dev && !_flash_dev->is_fram) {
+  if (_flash_dev && !flashDev()->is_fram) {
     if (_cache_en && !_cache) {
-      _cache = new Adafruit_FlashCache;
+      _cache = new Adafruit_FlashCache(_cache_lines);
+
+      // not enough memory for cache lines
+      if (_cache && !_cache->lineCount()) {
+        delete _cache;
+        _cache = NULL;
+      }
     }
   }
 #endif
-
-  return ret;
 }
 
 void Adafruit_SPIFlash::end(void) {
@@ -84,6 +105,224 @@ void Adafruit_SPIFlash::end(void) {
     delete _cache;
     _cache = NULL;
   }
+
+  free(_discard);
+  _discard = NULL;
+}
+
+#if SPIFLASH_STATS
+void Adafruit_SPIFlash::resetStats(void) {
+  Adafruit_SPIFlashBase::resetStats();
+
+  if (_cache) {
+    _cache->resetStats();
+  }
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Raw flash access
+//--------------------------------------------------------------------+
+
+uint32_t Adafruit_SPIFlash::writeBuffer(uint32_t address, uint8_t const *buffer,
+                                        uint32_t len, bool skipBlank) {
+  if (_cache) {
+    _cache->evict(this, address, len);
+  }
+  undiscard(address, len);
+  return Adafruit_SPIFlashBase::writeBuffer(address, buffer, len, skipBlank);
+}
+
+bool Adafruit_SPIFlash::erasePage(uint32_t pageNumber) {
+  if (_cache) {
+    _cache->evict(this, pageNumber * SFLASH_PAGE_SIZE, SFLASH_PAGE_SIZE);
+  }
+  return Adafruit_SPIFlashBase::erasePage(pageNumber);
+}
+
+bool Adafruit_SPIFlash::eraseSector(uint32_t sectorNumber) {
+  if (_cache) {
+    _cache->evict(this, sectorNumber * SFLASH_SECTOR_SIZE, SFLASH_SECTOR_SIZE);
+  }
+  return Adafruit_SPIFlashBase::eraseSector(sectorNumber);
+}
+
+bool Adafruit_SPIFlash::eraseBlock(uint32_t blockNumber) {
+  if (_cache) {
+    _cache->evict(this, blockNumber * SFLASH_BLOCK_SIZE, SFLASH_BLOCK_SIZE);
+  }
+  return Adafruit_SPIFlashBase::eraseBlock(blockNumber);
+}
+
+bool Adafruit_SPIFlash::eraseChip(void) {
+  if (_cache) {
+    _cache->evict(this, 0, size());
+  }
+  return Adafruit_SPIFlashBase::eraseChip();
+}
+
+bool Adafruit_SPIFlash::eraseRange(uint32_t address, uint32_t len,
+                                   bool skipBlank) {
+  if (_cache) {
+    _cache->evict(this, address, len);
+  }
+  return Adafruit_SPIFlashBase::eraseRange(address, len, skipBlank);
+}
+
+bool Adafruit_SPIFlash::startEraseSector(uint32_t sectorNumber) {
+  if (_cache) {
+    _cache->evict(this, sectorNumber * SFLASH_SECTOR_SIZE, SFLASH_SECTOR_SIZE);
+  }
+  return Adafruit_SPIFlashBase::startEraseSector(sectorNumber);
+}
+
+bool Adafruit_SPIFlash::startEraseBlock(uint32_t blockNumber) {
+  if (_cache) {
+    _cache->evict(this, blockNumber * SFLASH_BLOCK_SIZE, SFLASH_BLOCK_SIZE);
+  }
+  return Adafruit_SPIFlashBase::startEraseBlock(blockNumber);
+}
+
+bool Adafruit_SPIFlash::startEraseChip(void) {
+  if (_cache) {
+    _cache->evict(this, 0, size());
+  }
+  return Adafruit_SPIFlashBase::startEraseChip();
+}
+
+bool Adafruit_SPIFlash::startWrite(uint32_t address, uint8_t const *buffer,
+                                   uint32_t len, bool skipBlank) {
+  if (_cache) {
+    _cache->evict(this, address, len);
+  }
+  undiscard(address, len);
+  return Adafruit_SPIFlashBase::startWrite(address, buffer, len, skipBlank);
+}
+
+const uint8_t *Adafruit_SPIFlash::map(uint32_t address, uint32_t len) {
+  if (_cache) {
+    _cache->evict(this, address, len);
+  }
+  return Adafruit_SPIFlashBase::map(address, len);
+}
+
+//--------------------------------------------------------------------+
+// Discard
+//--------------------------------------------------------------------+
+
+bool Adafruit_SPIFlash::discard(uint32_t block, uint32_t count) {
+  uint32_t const blocks = sectorCount();
+
+  if (!_flash_dev || block > blocks || count > blocks - block) {
+    return false;
+  }
+
+  // FRAM is written in place
+  if (flashDev()->is_fram) {
+    return true;
+  }
+
+  uint32_t const sectors = size() / SFLASH_SECTOR_SIZE;
+  if (!_discard) {
+    _discard = (uint8_t *)calloc(sectors + (sectors + 7) / 8, 1);
+    if (!_discard) {
+      return false;
+    }
+  }
+
+  for (uint32_t b = block; b < block + count; b++) {
+    uint32_t const sector = b / BLOCKS_PER_SECTOR;
+    uint8_t const mask = _discard[sector];
+
+    _discard[sector] |= (uint8_t)(1u << (b % BLOCKS_PER_SECTOR));
+
+    // dirty data of the sector does not need to be written back anymore
+    if (_discard[sector] == 0xff && mask != 0xff && _cache) {
+      _cache->drop(sector * SFLASH_SECTOR_SIZE, SFLASH_SECTOR_SIZE);
+    }
+  }
+
+  return true;
+}
+
+bool Adafruit_SPIFlash::idleTask(void) {
+  // erase started by the previous call is still in progress
+  if (Adafruit_SPIFlashBase::idleTask()) {
+    return true;
+  }
+
+  if (!_discard) {
+    return false;
+  }
+
+  uint32_t const sectors = size() / SFLASH_SECTOR_SIZE;
+  uint8_t *erased = _discard + sectors;
+
+  for (uint32_t s = 0; s < sectors; s++) {
+    if (_discard[s] == 0xff && !isErasedDiscard(s)) {
+      if (startEraseSector(s)) {
+        erased[s / 8] |= (uint8_t)(1u << (s % 8));
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Range is being written, its sectors are not discarded nor erased anymore
+void Adafruit_SPIFlash::undiscard(uint32_t address, uint32_t len) {
+  if (!_discard || !len) {
+    return;
+  }
+
+  uint32_t const sectors = size() / SFLASH_SECTOR_SIZE;
+  uint8_t *erased = _discard + sectors;
+  uint32_t const end = min(address + len, size());
+
+  for (uint32_t b = address / LOGICAL_BLOCK_SIZE;
+       b * LOGICAL_BLOCK_SIZE < end; b++) {
+    uint32_t const sector = b / BLOCKS_PER_SECTOR;
+
+    _discard[sector] &= (uint8_t) ~(1u << (b % BLOCKS_PER_SECTOR));
+    erased[sector / 8] &= (uint8_t) ~(1u << (sector % 8));
+  }
+}
+
+// Write through the cache, a flash sector at a time when some are discarded
+// so that the cache knows which ones need no read or erase
+bool Adafruit_SPIFlash::cacheWrite(uint32_t block, uint8_t const *src,
+                                   uint32_t nb) {
+  if (!_discard) {
+    return _cache->write(this, block * LOGICAL_BLOCK_SIZE, src,
+                         LOGICAL_BLOCK_SIZE * nb);
+  }
+
+  while (nb) {
+    uint32_t const sector = block / BLOCKS_PER_SECTOR;
+    uint32_t const count =
+        min(nb, BLOCKS_PER_SECTOR - block % BLOCKS_PER_SECTOR);
+
+    uint8_t contents = Adafruit_FlashCache::SECTOR_USED;
+    if (_discard[sector] == 0xff && isErasedDiscard(sector)) {
+      contents = Adafruit_FlashCache::SECTOR_ERASED;
+    } else if (_discard[sector] == 0xff) {
+      contents = Adafruit_FlashCache::SECTOR_DISCARDED;
+    }
+
+    undiscard(block * LOGICAL_BLOCK_SIZE, count * LOGICAL_BLOCK_SIZE);
+
+    if (!_cache->write(this, block * LOGICAL_BLOCK_SIZE, src,
+                       count * LOGICAL_BLOCK_SIZE, contents)) {
+      return false;
+    }
+
+    block += count;
+    src += count * LOGICAL_BLOCK_SIZE;
+    nb -= count;
+  }
+
+  return true;
 }
 
 //--------------------------------------------------------------------+
@@ -124,8 +363,7 @@ bool Adafruit_SPIFlash::writeSector(uint32_t block, const uint8_t *src) {
   SPIFLASH_LOG(block, 1);
 
   if (_cache) {
-    return _cache->write(this, block * LOGICAL_BLOCK_SIZE, src,
-                         LOGICAL_BLOCK_SIZE);
+    return cacheWrite(block, src, 1);
   } else {
     return this->writeBuffer(block * LOGICAL_BLOCK_SIZE, src,
                              LOGICAL_BLOCK_SIZE) > 0;
@@ -148,8 +386,7 @@ bool Adafruit_SPIFlash::writeSectors(uint32_t block, const uint8_t *src,
                                      size_t nb) {
   SPIFLASH_LOG(block, nb);
   if (_cache) {
-    return _cache->write(this, block * LOGICAL_BLOCK_SIZE, src,
-                         LOGICAL_BLOCK_SIZE * nb);
+    return cacheWrite(block, src, nb);
   } else {
     return this->writeBuffer(block * LOGICAL_BLOCK_SIZE, src,
                              LOGICAL_BLOCK_SIZE * nb) > 0;
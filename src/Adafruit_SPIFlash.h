@@ -58,19 +58,69 @@
 // BaseBlockDriver interface. This allows it to be used with SdFat's
 // FatFileSystem class.
 //
-// Instances of this class will use 4kB of RAM as a block cache.
+// Instances of this class will use 4kB of RAM per cache line as a block cache.
 class Adafruit_SPIFlash : public FsBlockDeviceInterface,
                           public Adafruit_SPIFlashBase {
 public:
   Adafruit_SPIFlash();
-  Adafruit_SPIFlash(Adafruit_FlashTransport *transport, bool useCache = true);
+  Adafruit_SPIFlash(Adafruit_FlashTransport *transport, bool useCache = true,
+                    uint8_t cacheLines = 1);
   ~Adafruit_SPIFlash() {}
 
   bool begin(SPIFlash_Device_t const *flash_devs = NULL, size_t count = 1);
+  bool beginWarm(SPIFlash_State_t *state,
+                 SPIFlash_Device_t const *flash_devs = NULL, size_t count = 1);
   void end(void);
 
   bool isCached(void) { return _cache_en && (_cache != NULL); }
 
+#if SPIFLASH_STATS
+  // NULL if there is no cache
+  SPIFlash_CacheStats_t const *getCacheStats(void) {
+    return _cache ? _cache->getStats() : NULL;
+  }
+
+  // Reset both flash and cache statistics
+  void resetStats(void);
+#endif
+
+  // Raw flash write/erase. Cached sectors in the range are flushed and dropped
+  // first so that cache and flash contents stay coherent. These hide the
+  // Adafruit_SPIFlashBase methods, they do not override them: an instance with
+  // cache must only be accessed through Adafruit_SPIFlash, not through an
+  // Adafruit_SPIFlashBase pointer or reference (e.g Adafruit_FlashFTL) which
+  // bypasses the cache.
+  uint32_t writeBuffer(uint32_t address, uint8_t const *buffer, uint32_t len,
+                       bool skipBlank = false);
+  bool erasePage(uint32_t pageNumber);
+  bool eraseSector(uint32_t sectorNumber);
+  bool eraseBlock(uint32_t blockNumber);
+  bool eraseChip(void);
+  bool eraseRange(uint32_t address, uint32_t len, bool skipBlank = false);
+
+  // Non-blocking counterparts, flushing overlapping dirty sectors may block
+  bool startEraseSector(uint32_t sectorNumber);
+  bool startEraseBlock(uint32_t blockNumber);
+  bool startEraseChip(void);
+  bool startWrite(uint32_t address, uint8_t const *buffer, uint32_t len,
+                  bool skipBlank = false);
+
+  // Dirty cached sectors in the range are flushed first. Sectors written
+  // later are only visible through the mapping after syncDevice().
+  const uint8_t *map(uint32_t address, uint32_t len);
+
+  // Tell that blocks are not used anymore e.g freed clusters (FatFs
+  // CTRL_TRIM). Flash sectors whose blocks are all discarded are dropped from
+  // the cache and erased by idleTask(). Writing to them later does not read
+  // the sector, nor erase it once erased. Return false if the range is not
+  // valid or memory allocation fails (1 byte per flash sector).
+  bool discard(uint32_t block, uint32_t count);
+
+  // Background work when idle e.g from loop(): save the wear map, start
+  // erasing a discarded flash sector. Return false if there is nothing left to
+  // do.
+  bool idleTask(void);
+
   //------------- SdFat v2 FsBlockDeviceInterface API -------------//
   virtual bool isBusy();
   virtual uint32_t sectorCount();
@@ -102,7 +152,23 @@ public:
 
 protected:
   bool _cache_en;
+  uint8_t _cache_lines;
   Adafruit_FlashCache *_cache;
+
+  void initCache(void);
+
+  // Per flash sector, mask of discarded blocks. Followed by a bitmap of
+  // sectors erased since all their blocks were discarded. NULL until
+  // discard() is first called.
+  uint8_t *_discard;
+
+  bool isErasedDiscard(uint32_t sector) {
+    uint8_t const *erased = _discard + size() / SFLASH_SECTOR_SIZE;
+    return erased[sector / 8] & (1u << (sector % 8));
+  }
+
+  void undiscard(uint32_t address, uint32_t len);
+  bool cacheWrite(uint32_t block, uint8_t const *src, uint32_t nb);
 };
 
 #endif /* ADAFRUIT_SPIFLASH_H_ */
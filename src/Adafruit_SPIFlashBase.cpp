@@ -46,46 +46,129 @@
 
 #endif
 
-Adafruit_SPIFlashBase::Adafruit_SPIFlashBase() {
+#if SPIFLASH_STATS
+#define STATS_START(_command) statsStart(_command)
+#define STATS_DONE() statsDone()
+#define STATS_TIME(_start) uint32_t const _start = micros()
+#define STATS_RECORD(_lat, _start) stats_record(&_stats._lat, micros() - _start)
+#define STATS_ADD(_field, _count) _stats._field += (_count)
+
+static void stats_record(SPIFlash_Latency_t *lat, uint32_t us) {
+  if (lat->count == 0 || us < lat->min_us) {
+    lat->min_us = us;
+  }
+  if (us > lat->max_us) {
+    lat->max_us = us;
+  }
+
+  lat->count++;
+  lat->total_us += us;
+
+  // number of significant bits
+  uint32_t const bucket = us ? 32 - __builtin_clz(us) : 0;
+  lat->histogram[min(bucket, (uint32_t)SPIFLASH_STATS_BUCKETS - 1)]++;
+}
+#else
+#define STATS_START(_command)
+#define STATS_DONE()
+#define STATS_TIME(_start)
+#define STATS_RECORD(_lat, _start)
+#define STATS_ADD(_field, _count)
+#endif
+
+template <class Transport>
+Adafruit_SPIFlashBaseT<Transport>::Adafruit_SPIFlashBaseT() {
   _trans = NULL;
   _flash_dev = NULL;
   _ind_pin = -1;
   _ind_active = true;
+  _qpi_requested = false;
+  _write_pipelining = true;
+  _async_op = ASYNC_IDLE;
+  _async_failed = false;
+  _op_addr = _op_len = 0;
+  _resume_us = 0;
+  _ready = false;
+  _sleeping = false;
+  _auto_sleep_ms = 0;
+  _active_ms = 0;
+  _wear = NULL;
+  _wear_addr = 0;
+  _wear_interval = 0;
+  _wear_unsaved = 0;
+  _wear_seq = 0;
+#if SPIFLASH_STATS
+  _stats_op = NULL;
+  resetStats();
+#endif
 }
 
-Adafruit_SPIFlashBase::Adafruit_SPIFlashBase(
-    Adafruit_FlashTransport *transport) {
+template <class Transport>
+Adafruit_SPIFlashBaseT<Transport>::Adafruit_SPIFlashBaseT(
+    Transport *transport) {
   _trans = transport;
   _flash_dev = NULL;
   _ind_pin = -1;
   _ind_active = true;
+  _qpi_requested = false;
+  _write_pipelining = true;
+  _async_op = ASYNC_IDLE;
+  _async_failed = false;
+  _op_addr = _op_len = 0;
+  _resume_us = 0;
+  _ready = false;
+  _sleeping = false;
+  _auto_sleep_ms = 0;
+  _active_ms = 0;
+  _wear = NULL;
+  _wear_addr = 0;
+  _wear_interval = 0;
+  _wear_unsaved = 0;
+  _wear_seq = 0;
+#if SPIFLASH_STATS
+  _stats_op = NULL;
+  resetStats();
+#endif
 }
 
-#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_RP2040)
+//--------------------------------------------------------------------+
+// Warm start state
+//--------------------------------------------------------------------+
 
-// For ESP32 and RP2040 the SPI flash is already detected and configured
-// We could skip the initial sequence
-bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
-                                  size_t count) {
-  (void)flash_devs;
-  (void)count;
+#define SPIFLASH_STATE_MAGIC 0x53464C31 // "SFL1"
 
-  if (_trans == NULL) {
-    return false;
+static uint32_t fnv1a(void const *data, size_t len) {
+  uint8_t const *p = (uint8_t const *)data;
+  uint32_t hash = 2166136261UL;
+
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ p[i]) * 16777619UL;
   }
 
-  _trans->begin();
+  return hash;
+}
 
-#if defined(ARDUINO_ARCH_ESP32)
-  _flash_dev = ((Adafruit_FlashTransport_ESP32 *)_trans)->getFlashDevice();
-#elif defined(ARDUINO_ARCH_RP2040)
-  _flash_dev = ((Adafruit_FlashTransport_RP2040 *)_trans)->getFlashDevice();
-#endif
+// magic and device
+static uint32_t state_checksum(SPIFlash_State_t const *state) {
+  return fnv1a(state, offsetof(SPIFlash_State_t, checksum));
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::saveState(SPIFlash_State_t *state) {
+  if (!_flash_dev) {
+    return false;
+  }
+
+  // zero padding, it is covered by the checksum
+  memset(state, 0, sizeof(SPIFlash_State_t));
+  state->magic = SPIFLASH_STATE_MAGIC;
+  memcpy(&state->device, flashDev(), sizeof(SPIFlash_Device_t));
+  state->checksum = state_checksum(state);
 
   return true;
 }
 
-#else
+#ifndef SPIFLASH_DEVICE
 
 /// List of all possible flash devices used by Adafruit boards
 static const SPIFlash_Device_t possible_devices[] = {
@@ -110,6 +193,10 @@ enum {
       sizeof(possible_devices) / sizeof(possible_devices[0])
 };
 
+#endif
+
+#if !defined(SPIFLASH_DEVICE) || SPIFLASH_DEVICE_VERIFY
+
 static SPIFlash_Device_t const *findDevice(SPIFlash_Device_t const *device_list,
                                            int count,
                                            uint8_t const (&jedec_ids)[4]) {
@@ -124,15 +211,213 @@ static SPIFlash_Device_t const *findDevice(SPIFlash_Device_t const *device_list,
   return NULL;
 }
 
-bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
-                                  size_t count) {
+#endif
+
+//--------------------------------------------------------------------+
+// SFDP (JESD216)
+//--------------------------------------------------------------------+
+#ifndef SPIFLASH_DEVICE
+
+// SFDP has no clock information, this is supported by any device with fast
+// read and 1-1-4 read
+#define SFDP_CLOCK_MHZ 50
+
+static uint32_t get_le32(uint8_t const *buf) {
+  return buf[0] | (buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+         ((uint32_t)buf[3] << 24);
+}
+
+// Build device descriptor from the Basic Flash Parameter Table. Only devices
+// that work with the commands used by this library are accepted.
+static bool sfdp_to_device(Adafruit_FlashTransport *trans,
+                           uint8_t const (&jedec_ids)[4],
+                           SPIFlash_Device_t *dev) {
+  uint8_t header[16];
+
+  // SFDP header then 1st parameter header, which is always the BFPT
+  if (!trans->readSFDP(0, header, sizeof(header)) ||
+      get_le32(header) != 0x50444653 || header[8] != 0x00 ||
+      header[15] != 0xFF) {
+    return false;
+  }
+
+  // length in dwords, first 9 ones are defined since JESD216 initial release
+  uint8_t const count = min(header[11], (uint8_t)16);
+  if (count < 9) {
+    return false;
+  }
+
+  uint8_t bfpt[16 * 4];
+  memset(bfpt, 0, sizeof(bfpt));
+  if (!trans->readSFDP(get_le32(header + 12) & 0xFFFFFF, bfpt, 4 * count)) {
+    return false;
+  }
+
+  uint32_t dw[16];
+  for (uint8_t i = 0; i < 16; i++) {
+    dw[i] = get_le32(bfpt + 4 * i);
+  }
+
+  memset(dev, 0, sizeof(SPIFlash_Device_t));
+  dev->manufacturer_id = jedec_ids[0];
+  dev->memory_type = jedec_ids[1];
+  dev->capacity = jedec_ids[2];
+  dev->start_up_time_us = 10000;
+  dev->max_clock_speed_mhz = SFDP_CLOCK_MHZ;
+
+  // fast read 0x0B is mandatory for SFDP devices
+  dev->supports_fast_read = true;
+
+  // 2nd: density in bits
+  if (dw[1] & 0x80000000UL) {
+    uint32_t const n = dw[1] & 0x7FFFFFFFUL;
+    if (n < 3 || n > 34) {
+      return false;
+    }
+    dev->total_size = 1UL << (n - 3);
+  } else {
+    dev->total_size = (dw[1] / 8) + 1;
+  }
+
+  // 1st: 4KB erase with 0x20 is required for sector erase
+  if ((dw[0] & 0x03) != 0x01 ||
+      ((dw[0] >> 8) & 0xFF) != SFLASH_CMD_ERASE_SECTOR) {
+    return false;
+  }
+
+  // 8th, 9th: one of the erase types must be 64KB block erase 0xD8
+  bool has_block_erase = false;
+  for (uint8_t i = 0; i < 4; i++) {
+    uint32_t const type = (dw[7 + i / 2] >> (16 * (i % 2))) & 0xFFFF;
+    if ((type & 0xFF) == 16 && (type >> 8) == SFLASH_CMD_ERASE_BLOCK) {
+      has_block_erase = true;
+    }
+  }
+
+  if (!has_block_erase) {
+    return false;
+  }
+
+  // 11th: page size
+  if (count >= 11 && ((dw[10] >> 4) & 0x0F) != 8) {
+    return false;
+  }
+
+  // 1st: address bytes, 16th: enter 4-byte mode methods (0xB7 is bit 0)
+  uint8_t const addr_bytes = (dw[0] >> 17) & 0x03;
+  if (dev->total_size > 16UL * 1024 * 1024) {
+    if (addr_bytes == 0 || (count >= 16 && !(dw[15] & (1UL << 24)))) {
+      return false;
+    }
+  } else if (addr_bytes == 2) {
+    return false; // 4-byte address only
+  }
+
+  // 15th: quad enable requirement
+  uint8_t const qer = (count >= 15) ? ((dw[14] >> 20) & 0x07) : 0xFF;
+  bool qe_supported = true;
+
+  switch (qer) {
+  case 0: // no QE bit, second status register may not exist
+    dev->single_status_byte = true;
+    break;
+
+  case 1:
+  case 4:
+  case 5: // bit 1 of status register 2, written with 0x01 (2 bytes)
+    dev->quad_enable_bit_mask = 0x02;
+    break;
+
+  case 2: // bit 6 of status register 1
+    dev->quad_enable_bit_mask = 0x40;
+    dev->single_status_byte = true;
+    break;
+
+  case 6: // bit 1 of status register 2, written with 0x31
+    dev->quad_enable_bit_mask = 0x02;
+    dev->write_status_register_split = true;
+    break;
+
+  default: // unknown or not supported by this library
+    dev->single_status_byte = true;
+    qe_supported = false;
+    break;
+  }
+
+  // 1st, 3rd: 1-1-4 read 0x6B with 8 dummy cycles (including mode cycles)
+  uint8_t const quad_dummy = ((dw[2] >> 16) & 0x1F) + ((dw[2] >> 21) & 0x07);
+  if (qe_supported && (dw[0] & (1UL << 22)) &&
+      (dw[2] >> 24) == SFLASH_CMD_QUAD_READ && quad_dummy == 8) {
+    dev->supports_qspi = true;
+    dev->supports_qspi_writes = true;
+
+    // 1st, 3rd: 1-4-4 read 0xEB with 2 mode and 4 dummy cycles. Continuous
+    // read mode bits are not described in a common way, leave it off.
+    if ((dw[0] & (1UL << 21)) &&
+        ((dw[2] >> 8) & 0xFF) == SFLASH_CMD_QUAD_IO_READ &&
+        ((dw[2] >> 5) & 0x07) == 2 && (dw[2] & 0x1F) == 4) {
+      dev->supports_quad_io = true;
+    }
+  }
+
+  // 12th, 13th: suspend/resume, bit 31 is set if not supported
+  if (count >= 13 && !(dw[11] & (1UL << 31)) &&
+      (dw[12] >> 24) == SFLASH_CMD_SUSPEND &&
+      ((dw[12] >> 16) & 0xFF) == SFLASH_CMD_RESUME) {
+    dev->supports_suspend = true;
+  }
+
+  // 14th: deep power-down, bit 31 is set if not supported. Exit delay is
+  // (count + 1) units of 128 ns, 1 us, 8 us or 64 us.
+  if (count >= 14 && !(dw[13] & (1UL << 31)) &&
+      ((dw[13] >> 23) & 0xFF) == SFLASH_CMD_POWER_DOWN &&
+      ((dw[13] >> 15) & 0xFF) == SFLASH_CMD_RELEASE_POWER_DOWN) {
+    static const uint8_t unit_us[] = {0, 1, 8, 64};
+    uint32_t const n = ((dw[13] >> 8) & 0x1F) + 1;
+    uint8_t const unit = (dw[13] >> 13) & 0x03;
+    uint32_t const us = unit ? n * unit_us[unit] : (n * 128 + 999) / 1000;
+    dev->release_power_down_us = (us > 255) ? 255 : us;
+  }
+
+  return true;
+}
+
+#endif
+
+// Longest tRES1 of devices in the list
+#define RELEASE_POWER_DOWN_MAX_US 35
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::begin(
+    SPIFlash_Device_t const *flash_devs, size_t count) {
   if (_trans == NULL) {
     return false;
   }
 
   _trans->begin();
+  _ready = false;
+  _sleeping = false;
+
+  // ESP32 and RP2040 internal flash is already detected and configured by the
+  // core, skip the initial sequence
+  _flash_dev = _trans->getFlashDevice();
+  if (_flash_dev) {
+    return true;
+  }
+
+  // Device may have been left in deep power-down e.g by sleep() before a MCU
+  // reset, it is not known yet so wait for the longest tRES1
+  if (_trans->supportPowerDown()) {
+    _trans->runCommand(SFLASH_CMD_RELEASE_POWER_DOWN);
+    delayMicroseconds(RELEASE_POWER_DOWN_MAX_US);
+  }
 
   //------------- flash detection -------------//
+#if defined(SPIFLASH_DEVICE) && !SPIFLASH_DEVICE_VERIFY
+  (void)flash_devs;
+  (void)count;
+  _flash_dev = &spiflash_device;
+#else
   // Note: Manufacturer can be assigned with numerous of continuation code
   // (0x7F)
   uint8_t jedec_ids[4];
@@ -146,6 +431,11 @@ bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
     jedec_ids[2] = jedec_ids[3];
   }
 
+#ifdef SPIFLASH_DEVICE
+  (void)flash_devs;
+  (void)count;
+  _flash_dev = findDevice(&spiflash_device, 1, jedec_ids);
+#else
   // Check for device in supplied list, if any.
   if (flash_devs != NULL) {
     _flash_dev = findDevice(flash_devs, count, jedec_ids);
@@ -157,6 +447,12 @@ bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
         findDevice(possible_devices, EXTERNAL_FLASH_DEVICE_COUNT, jedec_ids);
   }
 
+  // If still not found, configure from device's SFDP tables
+  if (_flash_dev == NULL && sfdp_to_device(_trans, jedec_ids, &_local_dev)) {
+    _flash_dev = &_local_dev;
+  }
+#endif
+
   if (_flash_dev == NULL) {
 #if SPIFLASH_DEBUG
     Serial.print("Unknown flash device 0x");
@@ -165,18 +461,21 @@ bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
 #endif
     return false;
   }
+#endif
 
   // We don't know what state the flash is in so wait for any remaining writes
   // and then reset (Skip this procedure for FRAM)
-  if (!_flash_dev->is_fram) {
+  if (!flashDev()->is_fram) {
 
     // The write in progress bit should be low.
     while (readStatus() & 0x01) {
     }
 
-    // The suspended write/erase bit should be low.
-    if (!_flash_dev->single_status_byte) {
-      while (readStatus2() & 0x80) {
+    // The suspended write/erase bit should be low. It never clears by itself,
+    // resume and complete the operation (e.g MCU was reset during a read).
+    if (!flashDev()->single_status_byte && (readStatus2() & 0x80)) {
+      _trans->runCommand(SFLASH_CMD_RESUME);
+      while (readStatus() & 0x01) {
       }
     }
 
@@ -187,8 +486,83 @@ bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
     delayMicroseconds(30);
   }
 
+  configure(true);
+
+  writeDisable();
+  waitUntilReady();
+
+  return true;
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::beginWarm(
+    SPIFlash_State_t *state, SPIFlash_Device_t const *flash_devs,
+    size_t count) {
+  if (_trans == NULL) {
+    return false;
+  }
+
+  _flash_dev = NULL;
+
+  if (state->magic == SPIFLASH_STATE_MAGIC &&
+      state->checksum == state_checksum(state)) {
+#ifdef SPIFLASH_DEVICE
+    SPIFlash_Device_t const *dev = &state->device;
+    if (dev->manufacturer_id == spiflash_device.manufacturer_id &&
+        dev->memory_type == spiflash_device.memory_type &&
+        dev->capacity == spiflash_device.capacity) {
+      _flash_dev = &spiflash_device;
+    }
+#else
+    _local_dev = state->device;
+    _flash_dev = &_local_dev;
+#endif
+  }
+
+  if (_flash_dev) {
+    _trans->begin();
+    _sleeping = false;
+
+    // flash detected by the core, begin() is already fast
+    SPIFlash_Device_t const *core_dev = _trans->getFlashDevice();
+    if (core_dev) {
+      _flash_dev = core_dev;
+      _ready = false;
+      saveState(state);
+      return true;
+    }
+
+    if (powerDownSupported()) {
+      _trans->runCommand(SFLASH_CMD_RELEASE_POWER_DOWN);
+      delayMicroseconds(flashDev()->release_power_down_us);
+    }
+
+    configure(false);
+
+    // Status reads as all ones if the device is not connected or not powered
+    uint8_t const status = readStatus();
+    if (status != 0xFF) {
+      _ready = !(status & 0x03);
+      return true;
+    }
+
+    // begin() resets transport and device, including QPI mode
+    _trans->setQpiMode(false);
+    _flash_dev = NULL;
+  }
+
+  if (!begin(flash_devs, count)) {
+    return false;
+  }
+
+  saveState(state);
+  return true;
+}
+
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::configure(bool cold) {
   // Speed up to max device frequency, or as high as possible
-  uint32_t wr_speed = _flash_dev->max_clock_speed_mhz * 1000000U;
+  uint32_t wr_speed = flashDev()->max_clock_speed_mhz * 1000000U;
 
 #ifdef F_CPU
   // Limit to CPU speed if defined
@@ -206,39 +580,60 @@ bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
   _trans->setClockSpeed(wr_speed, rd_speed);
 
   // Enable Quad Mode if available
-  if (_trans->supportQuadMode() && _flash_dev->supports_qspi) {
-    // Verify that QSPI mode is enabled.
-    uint8_t status =
-        _flash_dev->single_status_byte ? readStatus() : readStatus2();
-
-    // Check the quad enable bit.
-    if ((status & _flash_dev->quad_enable_bit_mask) == 0) {
-      writeEnable();
+  if (_trans->supportQuadMode() && flashDev()->supports_qspi) {
+    // Check the quad enable bit, if device has one. It is non-volatile, no
+    // need to check again on warm start.
+    if (cold && flashDev()->quad_enable_bit_mask) {
+      // Verify that QSPI mode is enabled.
+      uint8_t status =
+          flashDev()->single_status_byte ? readStatus() : readStatus2();
+
+      if ((status & flashDev()->quad_enable_bit_mask) == 0) {
+        writeEnable();
+
+        uint8_t full_status[2] = {0x00, flashDev()->quad_enable_bit_mask};
+
+        if (flashDev()->write_status_register_split) {
+          _trans->writeCommand(SFLASH_CMD_WRITE_STATUS2, full_status + 1, 1);
+        } else if (flashDev()->single_status_byte) {
+          _trans->writeCommand(SFLASH_CMD_WRITE_STATUS, full_status + 1, 1);
+        } else {
+          _trans->writeCommand(SFLASH_CMD_WRITE_STATUS, full_status, 2);
+        }
+
+        // Status write takes a few ms, device ignores other commands meanwhile
+        waitUntilReady();
+      }
+    }
 
-      uint8_t full_status[2] = {0x00, _flash_dev->quad_enable_bit_mask};
+    // Quad I/O read also sends address on 4 lines
+    if (flashDev()->supports_quad_io) {
+      _trans->setReadCommand(SFLASH_CMD_QUAD_IO_READ);
+      _trans->setContinuousRead(flashDev()->supports_continuous_read);
+    }
 
-      if (_flash_dev->write_status_register_split) {
-        _trans->writeCommand(SFLASH_CMD_WRITE_STATUS2, full_status + 1, 1);
-      } else if (_flash_dev->single_status_byte) {
-        _trans->writeCommand(SFLASH_CMD_WRITE_STATUS, full_status + 1, 1);
-      } else {
-        _trans->writeCommand(SFLASH_CMD_WRITE_STATUS, full_status, 2);
-      }
+    if (_qpi_requested) {
+      enterQPI();
     }
   } else {
     // Single mode, use fast read if supported
-    if (_flash_dev->supports_fast_read) {
+    if (flashDev()->supports_fast_read) {
       _trans->setReadCommand(SFLASH_CMD_FAST_READ);
     }
   }
 
   // Addressing byte depends on total size
   uint8_t addr_byte;
-  if (_flash_dev->total_size > 16UL * 1024 * 1024) {
+  if (flashDev()->total_size > 16UL * 1024 * 1024) {
     addr_byte = 4;
-    // Enable 4-Byte address mode (This has to be done after the reset above)
-    _trans->runCommand(SFLASH_CMD_4_BYTE_ADDR);
-  } else if (_flash_dev->total_size > 64UL * 1024) {
+
+    // Prefer 4-byte address opcodes which leave device in 3-byte address mode
+    // expected by bootloaders. Otherwise enable 4-Byte address mode (This has
+    // to be done after the reset above)
+    if (!_trans->support4ByteOpcodes()) {
+      _trans->runCommand(SFLASH_CMD_4_BYTE_ADDR);
+    }
+  } else if (flashDev()->total_size > 64UL * 1024) {
     addr_byte = 3;
   } else {
     addr_byte = 2;
@@ -247,102 +642,185 @@ bool Adafruit_SPIFlashBase::begin(SPIFlash_Device_t const *flash_devs,
   _trans->setAddressLength(addr_byte);
 
   // Turn off sector protection if needed
-  //  if (_flash_dev->has_sector_protection)
+  //  if (flashDev()->has_sector_protection)
   //  {
   //    writeEnable();
   //
   //    uint8_t data[1] = {0x00};
   //    QSPI0.writeCommand(QSPI_CMD_WRITE_STATUS, data, 1);
   //  }
+}
 
-  writeDisable();
-  waitUntilReady();
+// Switch device and transport to QPI mode. Quad Enable bit must already be
+// set. Reads use 0xEB, whose 2 mode and 4 dummy cycles match the 1-4-4 frame.
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::enterQPI(void) {
+  uint8_t const command = flashDev()->qpi_enter_command;
+
+  // 4-byte address opcodes are not all available in QPI mode
+  if (!command || !_trans->supportQpiMode() ||
+      !flashDev()->supports_quad_io || size() > 16UL * 1024 * 1024) {
+    return false;
+  }
+
+  _trans->runCommand(command);
+  _trans->setQpiMode(true);
+
+  // Winbond defaults to 2 dummy cycles after the mode bits in QPI mode, set
+  // read parameters P5-P4 to 4 dummy cycles instead
+  if (command == SFLASH_CMD_ENTER_QPI) {
+    uint8_t const params = 0x10;
+    _trans->writeCommand(SFLASH_CMD_SET_READ_PARAMS, &params, 1);
+  }
 
   return true;
 }
 
-#endif // ARDUINO_ARCH_ESP32
-
-void Adafruit_SPIFlashBase::end(void) {
+template <class Transport> void Adafruit_SPIFlashBaseT<Transport>::end(void) {
   if (_trans == NULL) {
     return;
   }
 
+  // Bootloader and other firmware expect the device to be awake
+  wake();
+
+  // complete pending non-blocking write or erase
+  if (_flash_dev) {
+    waitUntilReady();
+  }
+
+  if (_wear) {
+    if (_wear_unsaved) {
+      saveWearMap();
+    }
+    free(_wear);
+    _wear = NULL;
+  }
+
+  // Leave QPI mode, bootloader and other firmware expect SPI mode
+  if (_flash_dev && _trans->qpiMode()) {
+    _trans->runCommand(flashDev()->qpi_enter_command == SFLASH_CMD_ENTER_QPI
+                           ? SFLASH_CMD_EXIT_QPI
+                           : SFLASH_CMD_EXIT_QPI_MX);
+    _trans->setQpiMode(false);
+  }
+
   _trans->end();
   _flash_dev = NULL;
+  _async_op = ASYNC_IDLE;
 }
 
-void Adafruit_SPIFlashBase::setIndicator(int pin, bool state_on) {
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::setIndicator(int pin, bool state_on) {
   _ind_pin = pin;
   _ind_active = state_on;
 }
 
-uint32_t Adafruit_SPIFlashBase::size(void) {
-  return _flash_dev ? _flash_dev->total_size : 0;
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::size(void) {
+  return _flash_dev ? flashDev()->total_size : 0;
 }
 
-uint32_t Adafruit_SPIFlashBase::numPages(void) {
-  return _flash_dev ? _flash_dev->total_size / pageSize() : 0;
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::numPages(void) {
+  return _flash_dev ? flashDev()->total_size / pageSize() : 0;
 }
 
-uint16_t Adafruit_SPIFlashBase::pageSize(void) { return SFLASH_PAGE_SIZE; }
+template <class Transport>
+uint16_t Adafruit_SPIFlashBaseT<Transport>::pageSize(void) {
+  return SFLASH_PAGE_SIZE;
+}
 
-uint32_t Adafruit_SPIFlashBase::getJEDECID(void) {
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::getJEDECID(void) {
   if (!_flash_dev) {
     return 0xFFFFFF;
   } else {
-    return (((uint32_t)_flash_dev->manufacturer_id) << 16) |
-           (_flash_dev->memory_type << 8) | _flash_dev->capacity;
+    return (((uint32_t)flashDev()->manufacturer_id) << 16) |
+           (flashDev()->memory_type << 8) | flashDev()->capacity;
   }
 }
 
-uint8_t Adafruit_SPIFlashBase::readStatus() {
+template <class Transport>
+uint8_t Adafruit_SPIFlashBaseT<Transport>::readStatus() {
   uint8_t status;
   _trans->readCommand(SFLASH_CMD_READ_STATUS, &status, 1);
   return status;
 }
 
-uint8_t Adafruit_SPIFlashBase::readStatus2(void) {
+template <class Transport>
+uint8_t Adafruit_SPIFlashBaseT<Transport>::readStatus2(void) {
   uint8_t status;
   _trans->readCommand(SFLASH_CMD_READ_STATUS2, &status, 1);
   return status;
 }
 
-bool Adafruit_SPIFlashBase::isReady(void) {
-  if (_flash_dev->is_fram) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::isReady(void) {
+  if (!poll()) {
+    return false;
+  }
+
+  if (flashDev()->is_fram || _sleeping) {
     return true;
   } else {
     return (readStatus() & 0x03) == 0;
   }
 }
 
-void Adafruit_SPIFlashBase::waitUntilReady(void) {
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::waitUntilReady(void) {
+  setActive();
+
+  // complete pending non-blocking operation
+  while (!poll()) {
+    yield();
+  }
+
   // FRAM has no need to wait for either read or write operation
-  if (_flash_dev->is_fram) {
+  if (flashDev()->is_fram) {
     return;
   }
 
+  // nothing issued since the last check, skip the status read which would
+  // also end continuous read mode
+  if (_ready) {
+    return;
+  }
+
+  STATS_TIME(start_us);
+
   // both WIP and WREN bit should be clear
   while (readStatus() & 0x03) {
     yield();
   }
+
+  STATS_RECORD(status_poll, start_us);
+  STATS_DONE();
+
+  _op_len = 0;
+  _ready = true;
 }
 
-bool Adafruit_SPIFlashBase::writeEnable(void) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::writeEnable(void) {
+  _ready = false;
   return _trans->runCommand(SFLASH_CMD_WRITE_ENABLE);
 }
 
-bool Adafruit_SPIFlashBase::writeDisable(void) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::writeDisable(void) {
   return _trans->runCommand(SFLASH_CMD_WRITE_DISABLE);
 }
 
-bool Adafruit_SPIFlashBase::erasePage(uint32_t pageNumber) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::erasePage(uint32_t pageNumber) {
   if (!_flash_dev) {
     return false;
   }
 
   // skip erase for FRAM
-  if (_flash_dev->is_fram) {
+  if (flashDev()->is_fram) {
     return true;
   }
 
@@ -356,19 +834,21 @@ bool Adafruit_SPIFlashBase::erasePage(uint32_t pageNumber) {
 
   bool const ret = _trans->eraseCommand(SFLASH_CMD_ERASE_PAGE,
                                         pageNumber * SFLASH_PAGE_SIZE);
+  setOperation(pageNumber * SFLASH_PAGE_SIZE, SFLASH_PAGE_SIZE);
 
   _indicator_off();
 
   return ret;
 }
 
-bool Adafruit_SPIFlashBase::eraseSector(uint32_t sectorNumber) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::eraseSector(uint32_t sectorNumber) {
   if (!_flash_dev) {
     return false;
   }
 
   // skip erase for FRAM
-  if (_flash_dev->is_fram) {
+  if (flashDev()->is_fram) {
     return true;
   }
 
@@ -382,19 +862,23 @@ bool Adafruit_SPIFlashBase::eraseSector(uint32_t sectorNumber) {
 
   bool const ret = _trans->eraseCommand(SFLASH_CMD_ERASE_SECTOR,
                                         sectorNumber * SFLASH_SECTOR_SIZE);
+  STATS_START(SFLASH_CMD_ERASE_SECTOR);
+  wearErase(sectorNumber * SFLASH_SECTOR_SIZE, SFLASH_SECTOR_SIZE);
+  setOperation(sectorNumber * SFLASH_SECTOR_SIZE, SFLASH_SECTOR_SIZE);
 
   _indicator_off();
 
   return ret;
 }
 
-bool Adafruit_SPIFlashBase::eraseBlock(uint32_t blockNumber) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::eraseBlock(uint32_t blockNumber) {
   if (!_flash_dev) {
     return false;
   }
 
   // skip erase for fram
-  if (_flash_dev->is_fram) {
+  if (flashDev()->is_fram) {
     return true;
   }
 
@@ -406,19 +890,23 @@ bool Adafruit_SPIFlashBase::eraseBlock(uint32_t blockNumber) {
 
   bool const ret = _trans->eraseCommand(SFLASH_CMD_ERASE_BLOCK,
                                         blockNumber * SFLASH_BLOCK_SIZE);
+  STATS_START(SFLASH_CMD_ERASE_BLOCK);
+  wearErase(blockNumber * SFLASH_BLOCK_SIZE, SFLASH_BLOCK_SIZE);
+  setOperation(blockNumber * SFLASH_BLOCK_SIZE, SFLASH_BLOCK_SIZE);
 
   _indicator_off();
 
   return ret;
 }
 
-bool Adafruit_SPIFlashBase::eraseChip(void) {
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::eraseChip(void) {
   if (!_flash_dev) {
     return false;
   }
 
   // skip erase for fram
-  if (_flash_dev->is_fram) {
+  if (flashDev()->is_fram) {
     return true;
   }
 
@@ -429,47 +917,272 @@ bool Adafruit_SPIFlashBase::eraseChip(void) {
   writeEnable();
 
   bool const ret = _trans->runCommand(SFLASH_CMD_ERASE_CHIP);
+  STATS_START(SFLASH_CMD_ERASE_CHIP);
+  wearErase(0, 0);
+  setOperation(0, 0);
+
+  _indicator_off();
+
+  return ret;
+}
+
+// Check if data is all 0xFF, a word at a time when aligned
+static bool is_blank(uint8_t const *buf, uint32_t len) {
+  if ((((uintptr_t)buf) & 3) == 0) {
+    uint32_t const *buf32 = (uint32_t const *)buf;
+    for (; len >= 4; len -= 4) {
+      if (*buf32++ != 0xFFFFFFFFUL) {
+        return false;
+      }
+    }
+    buf = (uint8_t const *)buf32;
+  }
+
+  while (len--) {
+    if (*buf++ != 0xFF) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Typical erase times of W25Q/GD25Q/MX25 are 45 ms (4K), 120 ms (32K) and
+// 150 ms (64K): a block erase is faster than erasing this many sectors.
+#define BLOCK32_MIN_DIRTY 3
+#define BLOCK_MIN_DIRTY 4
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::eraseRange(uint32_t address,
+                                                   uint32_t len,
+                                                   bool skipBlank) {
+  if (!_flash_dev || ((address | len) & (SFLASH_SECTOR_SIZE - 1)) ||
+      address > size() || len > size() - address) {
+    return false;
+  }
+
+  // skip erase for FRAM
+  if (flashDev()->is_fram) {
+    return true;
+  }
+
+  while (len) {
+    // largest unit aligned at address that fits in the range
+    uint32_t unit = SFLASH_SECTOR_SIZE;
+    if (!(address & (SFLASH_BLOCK_SIZE - 1)) && len >= SFLASH_BLOCK_SIZE) {
+      unit = SFLASH_BLOCK_SIZE;
+    } else if (hasBlock32Erase() && !(address & (SFLASH_BLOCK32_SIZE - 1)) &&
+               len >= SFLASH_BLOCK32_SIZE) {
+      unit = SFLASH_BLOCK32_SIZE;
+    }
+
+    bool ret;
+    if (skipBlank) {
+      // bitmap of sectors that are not blank
+      uint16_t dirty = 0;
+      for (uint8_t i = 0; i < unit / SFLASH_SECTOR_SIZE; i++) {
+        if (!isErased(address + i * SFLASH_SECTOR_SIZE, SFLASH_SECTOR_SIZE)) {
+          dirty |= (1U << i);
+        }
+      }
+      ret = eraseDirty(address, unit, dirty);
+    } else {
+      ret = eraseUnit(address, unit);
+    }
+
+    if (!ret) {
+      return false;
+    }
+
+    address += unit;
+    len -= unit;
+  }
+
+  return true;
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::isErased(uint32_t address,
+                                                 uint32_t len) {
+  uint32_t buf32[16]; // word aligned for is_blank()
+  uint8_t *buf = (uint8_t *)buf32;
+
+  while (len) {
+    uint32_t const count = min(len, (uint32_t)sizeof(buf32));
+
+    if (!readBuffer(address, buf, count) || !is_blank(buf, count)) {
+      return false;
+    }
+
+    address += count;
+    len -= count;
+  }
+
+  return true;
+}
+
+// Erase the dirty sectors of an aligned 64K/32K or smaller range, using a
+// block erase if enough of them are dirty, otherwise split it in halves.
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::eraseDirty(uint32_t address,
+                                                   uint32_t size,
+                                                   uint16_t dirty) {
+  if (!dirty) {
+    return true;
+  }
+
+  uint8_t count = 0;
+  for (uint16_t bits = dirty; bits; bits >>= 1) {
+    count += bits & 1;
+  }
+
+  if ((size == SFLASH_BLOCK_SIZE && count >= BLOCK_MIN_DIRTY) ||
+      (size == SFLASH_BLOCK32_SIZE && count >= BLOCK32_MIN_DIRTY &&
+       hasBlock32Erase()) ||
+      size == SFLASH_SECTOR_SIZE) {
+    return eraseUnit(address, size);
+  }
+
+  uint32_t const half = size / 2;
+  uint8_t const half_sectors = half / SFLASH_SECTOR_SIZE;
+
+  return eraseDirty(address, half, dirty & ((1U << half_sectors) - 1)) &&
+         eraseDirty(address + half, half, dirty >> half_sectors);
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::eraseUnit(uint32_t address,
+                                                  uint32_t size) {
+  uint8_t command;
+  if (size == SFLASH_BLOCK_SIZE) {
+    command = SFLASH_CMD_ERASE_BLOCK;
+  } else if (size == SFLASH_BLOCK32_SIZE) {
+    command = SFLASH_CMD_ERASE_BLOCK32;
+  } else {
+    command = SFLASH_CMD_ERASE_SECTOR;
+  }
+
+  _indicator_on();
+
+  // Before we erase we need to wait for any writes to finish
+  waitUntilReady();
+  writeEnable();
+
+  SPIFLASH_LOG(address, 0);
+
+  bool const ret = _trans->eraseCommand(command, address);
+  STATS_START(command);
+  wearErase(address, size);
+  setOperation(address, size);
 
   _indicator_off();
 
   return ret;
 }
 
-uint32_t Adafruit_SPIFlashBase::readBuffer(uint32_t address, uint8_t *buffer,
-                                           uint32_t len) {
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::readBuffer(uint32_t address,
+                                                       uint8_t *buffer,
+                                                       uint32_t len) {
   if (!_flash_dev) {
     return 0;
   }
 
   _indicator_on();
 
-  waitUntilReady();
   SPIFLASH_LOG(address, len);
-  bool const rc = _trans->readMemory(address, buffer, len);
+
+  bool rc;
+  if (canSuspend(address, len)) {
+    FlashIoVec const iov = {address, buffer, len};
+    STATS_TIME(start_us);
+    rc = readSuspended(&iov, 1);
+    STATS_RECORD(read, start_us);
+  } else {
+    waitUntilReady();
+    STATS_TIME(start_us);
+    rc = _trans->readMemory(address, buffer, len);
+    STATS_RECORD(read, start_us);
+  }
+  STATS_ADD(read_bytes, len);
 
   _indicator_off();
 
   return rc ? len : 0;
 }
 
-uint8_t Adafruit_SPIFlashBase::read8(uint32_t addr) {
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::readBufferV(FlashIoVec const *iov,
+                                                        uint32_t count) {
+  if (!_flash_dev) {
+    return 0;
+  }
+
+  _indicator_on();
+
+  uint32_t total = 0;
+  bool suspend = true;
+
+  for (uint32_t i = 0; i < count; i++) {
+    SPIFLASH_LOG(iov[i].addr, iov[i].len);
+    total += iov[i].len;
+    suspend = suspend && canSuspend(iov[i].addr, iov[i].len);
+  }
+
+  bool rc;
+  if (count && suspend) {
+    STATS_TIME(start_us);
+    rc = readSuspended(iov, count);
+    STATS_RECORD(read, start_us);
+  } else {
+    waitUntilReady();
+    STATS_TIME(start_us);
+    rc = _trans->readMemoryV(iov, count);
+    STATS_RECORD(read, start_us);
+  }
+  STATS_ADD(read_bytes, total);
+
+  _indicator_off();
+
+  return rc ? total : 0;
+}
+
+template <class Transport>
+const uint8_t *Adafruit_SPIFlashBaseT<Transport>::map(uint32_t address,
+                                                      uint32_t len) {
+  if (!_flash_dev || address > size() || len > size() - address) {
+    return NULL;
+  }
+
+  // flash is not readable while erasing or programming
+  waitUntilReady();
+
+  return _trans->map(address, len);
+}
+
+template <class Transport>
+uint8_t Adafruit_SPIFlashBaseT<Transport>::read8(uint32_t addr) {
   uint8_t ret;
   return readBuffer(addr, &ret, sizeof(ret)) ? ret : 0xff;
 }
 
-uint16_t Adafruit_SPIFlashBase::read16(uint32_t addr) {
+template <class Transport>
+uint16_t Adafruit_SPIFlashBaseT<Transport>::read16(uint32_t addr) {
   uint16_t ret;
   return readBuffer(addr, (uint8_t *)&ret, sizeof(ret)) ? ret : 0xffff;
 }
 
-uint32_t Adafruit_SPIFlashBase::read32(uint32_t addr) {
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::read32(uint32_t addr) {
   uint32_t ret;
   return readBuffer(addr, (uint8_t *)&ret, sizeof(ret)) ? ret : 0xffffffff;
 }
 
-uint32_t Adafruit_SPIFlashBase::writeBuffer(uint32_t address,
-                                            uint8_t const *buffer,
-                                            uint32_t len) {
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::writeBuffer(uint32_t address,
+                                                        uint8_t const *buffer,
+                                                        uint32_t len,
+                                                        bool skipBlank) {
   if (!_flash_dev) {
     return 0;
   }
@@ -480,27 +1193,53 @@ uint32_t Adafruit_SPIFlashBase::writeBuffer(uint32_t address,
 
   // FRAM: the whole chip can be written in one pass without waiting.
   // Also we need to explicitly disable WREN
-  if (_flash_dev->is_fram) {
+  if (flashDev()->is_fram) {
     writeEnable();
 
     _trans->writeMemory(address, buffer, len);
+    STATS_ADD(program_bytes, len);
 
     writeDisable();
   } else {
     uint32_t remain = len;
 
+    // Complete pending operation (e.g an erase) first, then transport waits
+    // for each page program and sends the next page as soon as it is done.
+    // Next page is prepared (blank check) while the previous one programs.
+    bool const pipelined =
+        _write_pipelining && _trans->supportPipelinedWrite();
+    if (pipelined) {
+      waitUntilReady();
+    }
+
     // write one page (256 bytes) at a time and
     // must not go over page boundary
     while (remain) {
-      waitUntilReady();
-      writeEnable();
-
       uint32_t const leftOnPage =
           SFLASH_PAGE_SIZE - (address & (SFLASH_PAGE_SIZE - 1));
       uint32_t const toWrite = min(remain, leftOnPage);
 
-      if (!_trans->writeMemory(address, buffer, toWrite)) {
-        break;
+      // erased page already holds 0xFF, skip WREN/program/busy wait
+      if (!(skipBlank && is_blank(buffer, toWrite))) {
+        bool rc;
+
+        if (pipelined) {
+          _ready = false;
+          rc = _trans->writeMemoryWhenReady(address, buffer, toWrite);
+          // previous page was done when this one was sent
+          STATS_DONE();
+        } else {
+          waitUntilReady();
+          writeEnable();
+          rc = _trans->writeMemory(address, buffer, toWrite);
+        }
+
+        if (!rc) {
+          break;
+        }
+        STATS_START(SFLASH_CMD_PAGE_PROGRAM);
+        STATS_ADD(program_bytes, toWrite);
+        setOperation(address, toWrite);
       }
 
       remain -= toWrite;
@@ -515,3 +1254,533 @@ uint32_t Adafruit_SPIFlashBase::writeBuffer(uint32_t address,
 
   return len;
 }
+
+//--------------------------------------------------------------------+
+// Non-blocking operations
+//--------------------------------------------------------------------+
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::startErase(uint8_t command,
+                                                   uint32_t address) {
+  if (!_flash_dev) {
+    return false;
+  }
+
+  // skip erase for FRAM
+  if (flashDev()->is_fram) {
+    return true;
+  }
+
+  setActive();
+
+  // previous operation must be completed
+  if (!poll() || (readStatus() & 0x01)) {
+    return false;
+  }
+  STATS_DONE();
+
+  _indicator_on();
+
+  SPIFLASH_LOG(address, 0);
+
+  writeEnable();
+  bool const ret = (command == SFLASH_CMD_ERASE_CHIP)
+                       ? _trans->runCommand(command)
+                       : _trans->eraseCommand(command, address);
+
+  if (ret) {
+    _async_op = ASYNC_ERASE;
+    STATS_START(command);
+
+    if (command == SFLASH_CMD_ERASE_SECTOR) {
+      setOperation(address, SFLASH_SECTOR_SIZE);
+      wearErase(address, SFLASH_SECTOR_SIZE);
+    } else if (command == SFLASH_CMD_ERASE_BLOCK) {
+      setOperation(address, SFLASH_BLOCK_SIZE);
+      wearErase(address, SFLASH_BLOCK_SIZE);
+    } else {
+      setOperation(0, 0);
+      wearErase(0, 0);
+    }
+  } else {
+    _indicator_off();
+  }
+
+  return ret;
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::startEraseSector(
+    uint32_t sectorNumber) {
+  return startErase(SFLASH_CMD_ERASE_SECTOR, sectorNumber * SFLASH_SECTOR_SIZE);
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::startEraseBlock(uint32_t blockNumber) {
+  return startErase(SFLASH_CMD_ERASE_BLOCK, blockNumber * SFLASH_BLOCK_SIZE);
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::startEraseChip(void) {
+  return startErase(SFLASH_CMD_ERASE_CHIP, 0);
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::startWrite(uint32_t address,
+                                                   uint8_t const *buffer,
+                                                   uint32_t len,
+                                                   bool skipBlank) {
+  if (!_flash_dev) {
+    return false;
+  }
+
+  // FRAM is written at bus speed, there is nothing to wait for
+  if (flashDev()->is_fram) {
+    _async_failed = writeBuffer(address, buffer, len) != len;
+    return !_async_failed;
+  }
+
+  setActive();
+
+  if (!poll() || (readStatus() & 0x01)) {
+    return false;
+  }
+  STATS_DONE();
+
+  SPIFLASH_LOG(address, len);
+
+  _async_addr = address;
+  _async_buf = buffer;
+  _async_remain = len;
+  _async_skip_blank = skipBlank;
+
+  // pages are programmed one after another, the whole range is in progress
+  setOperation(address, len);
+
+  _async_failed = false;
+  _indicator_on();
+
+  if (programNextPage()) {
+    _async_op = ASYNC_WRITE;
+  } else {
+    _op_len = 0;
+    _indicator_off();
+  }
+
+  return !_async_failed;
+}
+
+// Program next non-skipped page of pending write. Return false if there is
+// nothing left to program or the program failed (_async_failed is set).
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::programNextPage(void) {
+  while (_async_remain) {
+    uint32_t const leftOnPage =
+        SFLASH_PAGE_SIZE - (_async_addr & (SFLASH_PAGE_SIZE - 1));
+    uint32_t const toWrite = min(_async_remain, leftOnPage);
+
+    uint32_t const addr = _async_addr;
+    uint8_t const *buf = _async_buf;
+
+    _async_remain -= toWrite;
+    _async_buf += toWrite;
+    _async_addr += toWrite;
+
+    if (!(_async_skip_blank && is_blank(buf, toWrite))) {
+      writeEnable();
+
+      if (!_trans->writeMemory(addr, buf, toWrite)) {
+        // WREN may still be set, waitUntilReady() would wait for it forever
+        writeDisable();
+        _async_remain = 0;
+        _async_failed = true;
+        return false;
+      }
+
+      STATS_START(SFLASH_CMD_PAGE_PROGRAM);
+      STATS_ADD(program_bytes, toWrite);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+template <class Transport> bool Adafruit_SPIFlashBaseT<Transport>::poll(void) {
+  if (_async_op == ASYNC_IDLE) {
+    if (_auto_sleep_ms && !_sleeping && powerDownSupported() &&
+        millis() - _active_ms >= _auto_sleep_ms) {
+      // last page of writeBuffer() may still be in progress
+      if (_ready || !(readStatus() & 0x01)) {
+        powerDown();
+      }
+    }
+
+    return true;
+  }
+
+  // erase or page program still in progress
+  if (readStatus() & 0x01) {
+    return false;
+  }
+  STATS_DONE();
+
+  if (_async_op == ASYNC_WRITE && programNextPage()) {
+    return false;
+  }
+
+  _async_op = ASYNC_IDLE;
+  _op_len = 0;
+  _indicator_off();
+
+  return true;
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::idleTask(void) {
+  // pending operation is still in progress
+  if (!poll()) {
+    return true;
+  }
+
+  if (_wear && _wear_interval && _wear_unsaved >= _wear_interval) {
+    saveWearMap();
+  }
+
+  return false;
+}
+
+//--------------------------------------------------------------------+
+// Deep power-down
+//--------------------------------------------------------------------+
+
+template <class Transport> bool Adafruit_SPIFlashBaseT<Transport>::sleep(void) {
+  if (!powerDownSupported()) {
+    return false;
+  }
+
+  if (!_sleeping) {
+    waitUntilReady();
+    powerDown();
+  }
+
+  return true;
+}
+
+template <class Transport> bool Adafruit_SPIFlashBaseT<Transport>::wake(void) {
+  if (!_sleeping) {
+    return true;
+  }
+
+  _trans->runCommand(SFLASH_CMD_RELEASE_POWER_DOWN);
+  delayMicroseconds(flashDev()->release_power_down_us);
+  _sleeping = false;
+
+  // QPI mode was left by powerDown()
+  if (_qpi_requested) {
+    enterQPI();
+  }
+
+  return true;
+}
+
+// Device must be idle. It would still be in QPI mode after a MCU reset, when
+// begin() sends the release command on a single line: leave QPI mode first.
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::powerDown(void) {
+  if (_trans->qpiMode()) {
+    _trans->runCommand(flashDev()->qpi_enter_command == SFLASH_CMD_ENTER_QPI
+                           ? SFLASH_CMD_EXIT_QPI
+                           : SFLASH_CMD_EXIT_QPI_MX);
+    _trans->setQpiMode(false);
+  }
+
+  STATS_DONE();
+
+  _trans->runCommand(SFLASH_CMD_POWER_DOWN);
+  _sleeping = true;
+  _op_len = 0;
+}
+
+//--------------------------------------------------------------------+
+// Erase wear map
+//--------------------------------------------------------------------+
+
+#define WEAR_MAP_MAGIC 0x57454152 // "WEAR"
+
+// Each copy is a header followed by the counts. The copies are written
+// alternately, the header last, so that one is intact after a power loss.
+typedef struct {
+  uint32_t magic;
+  uint32_t sequence;
+  uint32_t sectors;
+  uint32_t checksum; // FNV-1a of counts
+} wear_header_t;
+
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::wearMapSize(void) {
+  uint32_t const copy_size =
+      sizeof(wear_header_t) + (size() / SFLASH_SECTOR_SIZE) * sizeof(uint16_t);
+
+  // two sector aligned copies
+  return 2 * ((copy_size + SFLASH_SECTOR_SIZE - 1) & ~(SFLASH_SECTOR_SIZE - 1));
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::beginWearMap(uint32_t address,
+                                                     uint32_t save_interval) {
+  free(_wear);
+  _wear = NULL;
+
+  if (!_flash_dev || flashDev()->is_fram ||
+      (address & (SFLASH_SECTOR_SIZE - 1)) || wearMapSize() > size() ||
+      address > size() - wearMapSize()) {
+    return false;
+  }
+
+  uint32_t const sectors = size() / SFLASH_SECTOR_SIZE;
+  uint32_t const copy_size = wearMapSize() / 2;
+
+  _wear = (uint16_t *)malloc(sectors * sizeof(uint16_t));
+  if (!_wear) {
+    return false;
+  }
+
+  _wear_addr = address;
+  _wear_interval = save_interval;
+  _wear_unsaved = 0;
+  _wear_seq = 0;
+
+  wear_header_t hdr[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    readBuffer(address + i * copy_size, (uint8_t *)&hdr[i], sizeof(hdr[i]));
+  }
+
+  // newest intact copy, none if the region was never saved
+  uint8_t const newest = (hdr[1].sequence > hdr[0].sequence) ? 1 : 0;
+  for (uint8_t n = 0; n < 2; n++) {
+    wear_header_t const *h = &hdr[newest ^ n];
+
+    if (h->magic == WEAR_MAP_MAGIC && h->sectors == sectors) {
+      readBuffer(address + (newest ^ n) * copy_size + sizeof(wear_header_t),
+                 (uint8_t *)_wear, sectors * sizeof(uint16_t));
+
+      if (fnv1a(_wear, sectors * sizeof(uint16_t)) == h->checksum) {
+        _wear_seq = h->sequence;
+        return true;
+      }
+    }
+  }
+
+  memset(_wear, 0, sectors * sizeof(uint16_t));
+  return true;
+}
+
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::saveWearMap(void) {
+  uint16_t *const wear = _wear;
+  if (!wear) {
+    return false;
+  }
+
+  uint32_t const sectors = size() / SFLASH_SECTOR_SIZE;
+  uint32_t const copy_size = wearMapSize() / 2;
+  uint32_t const seq = _wear_seq + 1;
+  uint32_t const addr = _wear_addr + (seq & 1) * copy_size;
+
+  // Erases of the copy are counted up front so that the saved map includes
+  // them. Map is detached meanwhile so that eraseSector() does not count them
+  // twice.
+  wearErase(addr, copy_size);
+  _wear = NULL;
+
+  for (uint32_t off = 0; off < copy_size; off += SFLASH_SECTOR_SIZE) {
+    eraseSector((addr + off) / SFLASH_SECTOR_SIZE);
+  }
+
+  uint32_t const len = sectors * sizeof(uint16_t);
+  wear_header_t const hdr = {WEAR_MAP_MAGIC, seq, sectors, fnv1a(wear, len)};
+
+  bool const ok =
+      writeBuffer(addr + sizeof(hdr), (uint8_t const *)wear, len) == len &&
+      writeBuffer(addr, (uint8_t const *)&hdr, sizeof(hdr)) == sizeof(hdr);
+
+  // leave device idle, a non-blocking operation may be started next
+  waitUntilReady();
+
+  _wear = wear;
+  if (ok) {
+    _wear_seq = seq;
+    _wear_unsaved = 0;
+  }
+
+  return ok;
+}
+
+template <class Transport>
+uint16_t Adafruit_SPIFlashBaseT<Transport>::eraseCount(uint32_t sectorNumber) {
+  if (!_wear || sectorNumber >= size() / SFLASH_SECTOR_SIZE) {
+    return 0;
+  }
+
+  return _wear[sectorNumber];
+}
+
+template <class Transport>
+uint32_t Adafruit_SPIFlashBaseT<Transport>::hotSectors(uint32_t *sectors,
+                                                       uint32_t count) {
+  if (!_wear || !count) {
+    return 0;
+  }
+
+  uint32_t found = 0;
+
+  // insertion into the sorted result, count is expected to be small
+  for (uint32_t s = 0; s < size() / SFLASH_SECTOR_SIZE; s++) {
+    if (_wear[s] == 0 ||
+        (found == count && _wear[s] <= _wear[sectors[count - 1]])) {
+      continue;
+    }
+
+    uint32_t i = (found < count) ? found++ : count - 1;
+    while (i > 0 && _wear[sectors[i - 1]] < _wear[s]) {
+      sectors[i] = sectors[i - 1];
+      i--;
+    }
+    sectors[i] = s;
+  }
+
+  return found;
+}
+
+// Count erase of [address, address + len), len = 0 for the whole chip
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::wearErase(uint32_t address,
+                                                  uint32_t len) {
+  if (!_wear) {
+    return;
+  }
+
+  if (len == 0) {
+    address = 0;
+    len = size();
+  }
+
+  // erase commands are not range checked, sectors past the end are not counted
+  uint32_t const sectors = size() / SFLASH_SECTOR_SIZE;
+  uint32_t const first = address / SFLASH_SECTOR_SIZE;
+  uint32_t const last = min(first + len / SFLASH_SECTOR_SIZE, sectors);
+
+  for (uint32_t s = first; s < last; s++) {
+    if (_wear[s] != UINT16_MAX) {
+      _wear[s]++;
+    }
+  }
+
+  _wear_unsaved++;
+}
+
+//--------------------------------------------------------------------+
+// Erase/program suspend
+//--------------------------------------------------------------------+
+
+// Minimum time between resume and the next suspend. Without it, back to back
+// reads could starve the erase which then never completes.
+#define SUSPEND_INTERVAL_US 100
+
+// Read while an erase/program outside of the read ranges is in progress, by
+// suspending the operation instead of waiting for it to complete.
+template <class Transport>
+bool Adafruit_SPIFlashBaseT<Transport>::readSuspended(FlashIoVec const *iov,
+                                                      uint32_t count) {
+  // completed, or in between pages of startWrite()
+  if (!(readStatus() & 0x01)) {
+    STATS_DONE();
+    return _trans->readMemoryV(iov, count);
+  }
+
+  uint32_t const elapsed = micros() - _resume_us;
+  if (elapsed < SUSPEND_INTERVAL_US) {
+    delayMicroseconds(SUSPEND_INTERVAL_US - elapsed);
+  }
+
+  _trans->runCommand(SFLASH_CMD_SUSPEND);
+
+  // WIP is cleared once suspended (tSUS) or if the operation just completed
+  while (readStatus() & 0x01) {
+    yield();
+  }
+
+  bool const rc = _trans->readMemoryV(iov, count);
+
+  // ignored by device if nothing was suspended
+  _trans->runCommand(SFLASH_CMD_RESUME);
+  _resume_us = micros();
+
+  return rc;
+}
+
+//--------------------------------------------------------------------+
+// Statistics
+//--------------------------------------------------------------------+
+
+#if SPIFLASH_STATS
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::resetStats(void) {
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+// Erase or page program command was just issued
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::statsStart(uint8_t command) {
+  switch (command) {
+  case SFLASH_CMD_ERASE_SECTOR:
+    _stats_op = &_stats.sector_erase;
+    break;
+
+  case SFLASH_CMD_ERASE_BLOCK32:
+  case SFLASH_CMD_ERASE_BLOCK:
+    _stats_op = &_stats.block_erase;
+    break;
+
+  case SFLASH_CMD_ERASE_CHIP:
+    _stats_op = &_stats.chip_erase;
+    break;
+
+  default:
+    _stats_op = &_stats.page_program;
+    break;
+  }
+
+  _stats_op_us = micros();
+}
+
+// Status read showed the device idle
+template <class Transport>
+void Adafruit_SPIFlashBaseT<Transport>::statsDone(void) {
+  if (_stats_op) {
+    stats_record(_stats_op, micros() - _stats_op_us);
+    _stats_op = NULL;
+  }
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Explicit instantiations
+//--------------------------------------------------------------------+
+
+template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport>;
+template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_SPI>;
+template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_Sim>;
+
+#if defined(__SAMD51__) || defined(NRF52840_XXAA)
+template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_QSPI>;
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_ESP32>;
+#endif
+
+#if defined(ARDUINO_ARCH_RP2040)
+template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_RP2040>;
+#endif
@@ -31,21 +31,106 @@
 // for debugging
 #define SPIFLASH_DEBUG 0
 
+// Record operation counts and latencies, see getStats(). Costs two micros()
+// calls per operation and about 650 bytes of RAM, e.g build flag
+// -DSPIFLASH_STATS=1
+#ifndef SPIFLASH_STATS
+#define SPIFLASH_STATS 0
+#endif
+
+#if SPIFLASH_STATS
+#define SPIFLASH_STATS_BUCKETS 20
+
+// Latencies of an operation in microseconds. Histogram bucket 0 counts the
+// ones below 1 us, bucket i those in [2^(i-1), 2^i) and the last bucket
+// everything above.
+typedef struct {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t histogram[SPIFLASH_STATS_BUCKETS];
+} SPIFlash_Latency_t;
+
+typedef struct {
+  SPIFlash_Latency_t read;         // transfer, or suspend and transfer
+  SPIFlash_Latency_t page_program; // issue until seen done by a status read
+  SPIFlash_Latency_t sector_erase; // 4K
+  SPIFlash_Latency_t block_erase;  // 32K and 64K
+  SPIFlash_Latency_t chip_erase;
+  SPIFlash_Latency_t status_poll; // blocked in waitUntilReady()
+  uint64_t read_bytes;
+  uint64_t program_bytes;
+} SPIFlash_Stats_t;
+#endif
+
+// Board's flash device known at compile time, e.g build flag
+// -DSPIFLASH_DEVICE=W25Q16JV_IQ. begin() then skips detection: the device list
+// and SFDP parser are not linked, and the device parameters are constants.
+// SPIFLASH_DEVICE_VERIFY = 1 still checks the JEDEC ID in begin().
+#ifdef SPIFLASH_DEVICE
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_RP2040)
+#error "SPIFLASH_DEVICE is not supported, flash is detected by the core"
+#endif
+
+#ifndef SPIFLASH_DEVICE_VERIFY
+#define SPIFLASH_DEVICE_VERIFY 0
+#endif
+
+static const SPIFlash_Device_t spiflash_device = SPIFLASH_DEVICE;
+#endif
+
+// Device detected by begin(), saved with saveState() e.g to RAM retained in
+// deep sleep so that beginWarm() can skip detection and reset.
+typedef struct {
+  uint32_t magic;
+  SPIFlash_Device_t device;
+  uint32_t checksum;
+} SPIFlash_State_t;
+
 // An easy to use interface for working with Flash memory.
 //
 // If you are managing allocation of the Flash space yourself, this is the
 // class to use as it take very little RAM.
-class Adafruit_SPIFlashBase {
+//
+// Transport is the interface used to talk to the flash. The
+// Adafruit_SPIFlashBase alias works with any transport, including subclasses
+// defined by the application, through virtual calls. Member definitions are
+// only compiled for the transports listed at the end of this file, e.g
+// Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_SPI>: calls then go to that
+// class, which lets the compiler devirtualize them. Other transport types fail
+// to link, use Adafruit_SPIFlashBase with them.
+template <class Transport> class Adafruit_SPIFlashBaseT {
 public:
-  Adafruit_SPIFlashBase();
-  Adafruit_SPIFlashBase(Adafruit_FlashTransport *transport);
-  ~Adafruit_SPIFlashBase() {}
+  Adafruit_SPIFlashBaseT();
+  Adafruit_SPIFlashBaseT(Transport *transport);
+  ~Adafruit_SPIFlashBaseT() {}
 
   bool begin(SPIFlash_Device_t const *flash_devs = NULL, size_t count = 1);
   void end(void);
 
+  // Fast begin e.g after waking up from deep sleep, with the device restored
+  // from state. Only a status read checks that the device responds. If state
+  // is not valid or the check fails, fall back to begin() and save to state.
+  // Device must have been left idle, call waitUntilReady() before sleeping.
+  bool beginWarm(SPIFlash_State_t *state,
+                 SPIFlash_Device_t const *flash_devs = NULL, size_t count = 1);
+
+  // Save the device in use, return false if begin() has not succeeded
+  bool saveState(SPIFlash_State_t *state);
+
   void setIndicator(int pin, bool state_on = true);
 
+  // Opt in QPI (4-4-4) mode, must be called before begin(). Opcode and address
+  // also use 4 lines, which cuts the overhead of small transfers. Only used if
+  // both device and transport support it.
+  void setQPI(bool enabled) { _qpi_requested = enabled; }
+
+  // Pipeline back to back page programs of writeBuffer() if the transport
+  // supports it (default). Can be turned off to compare.
+  void setWritePipelining(bool enabled) { _write_pipelining = enabled; }
+
   uint32_t numPages(void);
   uint16_t pageSize(void);
 
@@ -61,25 +146,214 @@ public:
   uint32_t getJEDECID(void);
 
   uint32_t readBuffer(uint32_t address, uint8_t *buffer, uint32_t len);
-  uint32_t writeBuffer(uint32_t address, uint8_t const *buffer, uint32_t len);
+  // Read scattered segments with a single status check, return total number
+  // of bytes read or 0 on error
+  uint32_t readBufferV(FlashIoVec const *iov, uint32_t count);
+  // skipBlank: pages that are all 0xFF are not programmed. Only valid if the
+  // destination is known to be erased.
+  uint32_t writeBuffer(uint32_t address, uint8_t const *buffer, uint32_t len,
+                       bool skipBlank = false);
 
   bool erasePage(uint32_t pageNumber);
   bool eraseSector(uint32_t sectorNumber);
   bool eraseBlock(uint32_t blockNumber);
   bool eraseChip(void);
 
+  // Erase [address, address + len) with the fewest 64K, 32K and 4K erases,
+  // both must be sector aligned. skipBlank: sectors that are already blank are
+  // left alone, a larger unit is only used if enough of its sectors need it.
+  bool eraseRange(uint32_t address, uint32_t len, bool skipBlank = false);
+
+  // Return true if all bytes in the range read as 0xFF
+  bool isErased(uint32_t address, uint32_t len);
+
+  //------------- Non-blocking operations -------------//
+  // Start an erase or write and return without waiting for it to complete.
+  // They fail if the device is still busy or the first command fails. poll()
+  // must then be called until it returns true, startWrite() buffer must stay
+  // valid until then. Blocking calls complete the pending operation first.
+  bool startEraseSector(uint32_t sectorNumber);
+  bool startEraseBlock(uint32_t blockNumber);
+  bool startEraseChip(void);
+  bool startWrite(uint32_t address, uint8_t const *buffer, uint32_t len,
+                  bool skipBlank = false);
+
+  // Advance the pending operation (program next page when the previous one is
+  // done). Return true if no operation is pending anymore, either completed or
+  // failed.
+  bool poll(void);
+
+  // Return true if no operation is pending, without accessing the device
+  bool isDone(void) { return _async_op == ASYNC_IDLE; }
+
+  // Return true if a page program of the last startWrite() failed, remaining
+  // pages were not programmed
+  bool isFailed(void) { return _async_failed; }
+
+  // Background work when idle e.g from loop(): save the wear map, which takes
+  // a sector erase. Return false if there is nothing left to do.
+  bool idleTask(void);
+
+  //------------- Deep power-down -------------//
+  // Put device in deep power-down (0xB9) once pending operations complete.
+  // Return false if not supported by device or transport. Reads, writes and
+  // erases wake it up as needed.
+  bool sleep(void);
+
+  // Release device from deep power-down (0xAB) and wait for tRES1
+  bool wake(void);
+  bool isSleeping(void) { return _sleeping; }
+
+  // Put device in deep power-down from poll() once there was no access for
+  // idle_ms, 0 to disable (default). Memory returned by map() is not readable
+  // while the device is asleep.
+  void setAutoSleep(uint32_t idle_ms) { _auto_sleep_ms = idle_ms; }
+
+  //------------- Erase wear map -------------//
+  // Count erases of each 4K sector, saturating at 65535. Takes 2 bytes of RAM
+  // per sector. Counts are loaded from and saved to wearMapSize() bytes at
+  // address: a sector aligned region reserved by the application e.g at the
+  // end of flash, outside of the FAT volume. They are saved by idleTask() once
+  // save_interval erases are pending (0: only by saveWearMap() and end()).
+  // Must be called after begin(), return false if the region is not valid or
+  // memory allocation fails.
+  bool beginWearMap(uint32_t address, uint32_t save_interval = 64);
+  bool saveWearMap(void);
+  uint32_t wearMapSize(void);
+
+  uint16_t eraseCount(uint32_t sectorNumber);
+
+  // Fill sectors with up to count sector numbers, most erased first. Sectors
+  // never erased are left out. Return number of sectors filled.
+  uint32_t hotSectors(uint32_t *sectors, uint32_t count);
+
+  // Pointer to flash contents mapped in the CPU address space (XIP) to be
+  // read in place, NULL if not supported by the transport. It stays valid
+  // until end() and reflects later writes and erases once they complete.
+  const uint8_t *map(uint32_t address, uint32_t len);
+
   // Helper
   uint8_t read8(uint32_t addr);
   uint16_t read16(uint32_t addr);
   uint32_t read32(uint32_t addr);
 
+#if SPIFLASH_STATS
+  // Operations are only seen done when the status is read, e.g by poll() or
+  // the next operation: their latency is an upper bound.
+  SPIFlash_Stats_t const *getStats(void) { return &_stats; }
+  void resetStats(void);
+#endif
+
 protected:
-  Adafruit_FlashTransport *_trans;
+  Transport *_trans;
   SPIFlash_Device_t const *_flash_dev;
 
+  // Device in use once begin() succeeded. Parameters are folded into the code
+  // with SPIFLASH_DEVICE.
+  SPIFlash_Device_t const *flashDev(void) {
+#ifdef SPIFLASH_DEVICE
+    return &spiflash_device;
+#else
+    return _flash_dev;
+#endif
+  }
+
+#ifndef SPIFLASH_DEVICE
+  // Device not in any list built from its SFDP tables, or restored by
+  // beginWarm()
+  SPIFlash_Device_t _local_dev;
+#endif
+
   int _ind_pin;
   bool _ind_active;
 
+  bool _qpi_requested;
+  bool _write_pipelining;
+  bool enterQPI(void);
+
+  // Set up clock, read mode and addressing of transport and device once
+  // _flash_dev is known. cold: device was just reset, check quad enable bit.
+  void configure(bool cold);
+
+  enum { ASYNC_IDLE, ASYNC_ERASE, ASYNC_WRITE };
+
+  uint8_t _async_op;
+  bool _async_failed;
+  bool _async_skip_blank;
+  uint32_t _async_addr;
+  uint8_t const *_async_buf;
+  uint32_t _async_remain;
+
+  bool startErase(uint8_t command, uint32_t address);
+
+  // 32K block erase 0x52 has no 4-byte address variant
+  bool hasBlock32Erase(void) { return size() <= 16UL * 1024 * 1024; }
+
+  bool eraseUnit(uint32_t address, uint32_t size);
+  bool eraseDirty(uint32_t address, uint32_t size, uint16_t dirty);
+  bool programNextPage(void);
+
+  // Range of the last erase/program which may still be in progress, reads
+  // outside of it can suspend the operation. len = 0 if nothing is issued or
+  // the operation (e.g chip erase) cannot be suspended.
+  uint32_t _op_addr;
+  uint32_t _op_len;
+  uint32_t _resume_us;
+
+  // Status showed the device idle and no write enable was sent since
+  bool _ready;
+
+  bool _sleeping;
+  uint32_t _auto_sleep_ms;
+  uint32_t _active_ms; // last access, only updated if auto sleep is enabled
+
+  bool powerDownSupported(void) {
+    return _flash_dev && flashDev()->release_power_down_us &&
+           _trans->supportPowerDown();
+  }
+
+  void powerDown(void);
+
+  // Called before accessing the device
+  void setActive(void) {
+    if (_sleeping) {
+      wake();
+    }
+
+    if (_auto_sleep_ms) {
+      _active_ms = millis();
+    }
+  }
+
+  void setOperation(uint32_t addr, uint32_t len) {
+    _op_addr = addr;
+    _op_len = (_flash_dev && flashDev()->supports_suspend) ? len : 0;
+  }
+
+  bool canSuspend(uint32_t address, uint32_t len) {
+    return _op_len &&
+           (address >= _op_addr + _op_len || _op_addr >= address + len);
+  }
+
+  bool readSuspended(FlashIoVec const *iov, uint32_t count);
+
+  uint16_t *_wear; // erase count per sector, NULL if there is no wear map
+  uint32_t _wear_addr;
+  uint32_t _wear_interval;
+  uint32_t _wear_unsaved; // erases since the last save
+  uint32_t _wear_seq;     // sequence of the last saved copy
+
+  void wearErase(uint32_t address, uint32_t len);
+
+#if SPIFLASH_STATS
+  SPIFlash_Stats_t _stats;
+  SPIFlash_Latency_t *_stats_op; // erase/program in progress
+  uint32_t _stats_op_us;
+
+  void statsStart(uint8_t command);
+  void statsDone(void);
+#endif
+
   void _indicator_on(void) {
     if (_ind_pin >= 0) {
       digitalWrite(_ind_pin, _ind_active ? HIGH : LOW);
@@ -93,4 +367,23 @@ protected:
   }
 };
 
+typedef Adafruit_SPIFlashBaseT<Adafruit_FlashTransport> Adafruit_SPIFlashBase;
+
+// Instantiated in Adafruit_SPIFlashBase.cpp, the only supported transports
+extern template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport>;
+extern template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_SPI>;
+extern template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_Sim>;
+
+#if defined(__SAMD51__) || defined(NRF52840_XXAA)
+extern template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_QSPI>;
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+extern template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_ESP32>;
+#endif
+
+#if defined(ARDUINO_ARCH_RP2040)
+extern template class Adafruit_SPIFlashBaseT<Adafruit_FlashTransport_RP2040>;
+#endif
+
 #endif /* ADAFRUIT_SPIFLASHBASE_H_ */
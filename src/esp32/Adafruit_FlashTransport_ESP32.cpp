@@ -27,13 +27,27 @@
 #ifdef ARDUINO_ARCH_ESP32
 
 #include "esp_flash.h"
+#include "esp_idf_version.h"
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include "spi_flash_mmap.h"
+#define PARTITION_MMAP_DATA ESP_PARTITION_MMAP_DATA
+#else
+#include "esp_spi_flash.h"
+#define PARTITION_MMAP_DATA SPI_FLASH_MMAP_DATA
+#endif
 
 Adafruit_FlashTransport_ESP32::Adafruit_FlashTransport_ESP32(void) {
   _cmd_read = SFLASH_CMD_READ;
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
 
   _partition = NULL;
   memset(&_flash_device, 0, sizeof(_flash_device));
+
+  _map_ptr = NULL;
+  _map_handle = 0;
 }
 
 void Adafruit_FlashTransport_ESP32::begin(void) {
@@ -48,6 +62,13 @@ void Adafruit_FlashTransport_ESP32::begin(void) {
 void Adafruit_FlashTransport_ESP32::end(void) {
   _cmd_read = SFLASH_CMD_READ;
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
+
+  if (_map_ptr) {
+    spi_flash_munmap(_map_handle);
+    _map_ptr = NULL;
+  }
 
   _partition = NULL;
   memset(&_flash_device, 0, sizeof(_flash_device));
@@ -114,6 +135,8 @@ bool Adafruit_FlashTransport_ESP32::eraseCommand(uint8_t command,
 
   if (command == SFLASH_CMD_ERASE_SECTOR) {
     erase_sz = SFLASH_SECTOR_SIZE;
+  } else if (command == SFLASH_CMD_ERASE_BLOCK32) {
+    erase_sz = SFLASH_BLOCK32_SIZE;
   } else if (command == SFLASH_CMD_ERASE_BLOCK) {
     erase_sz = SFLASH_BLOCK_SIZE;
   } else {
@@ -134,4 +157,26 @@ bool Adafruit_FlashTransport_ESP32::writeMemory(uint32_t addr,
   return ESP_OK == esp_partition_write(_partition, addr, data, len);
 }
 
+const uint8_t *Adafruit_FlashTransport_ESP32::map(uint32_t addr,
+                                                  uint32_t len) {
+  if (!_partition || addr > _partition->size ||
+      len > _partition->size - addr) {
+    return NULL;
+  }
+
+  // Map the whole partition once so that pointers from previous calls stay
+  // valid. Cache is flushed by esp_partition_erase_range()/write().
+  if (!_map_ptr) {
+    const void *ptr;
+    if (ESP_OK != esp_partition_mmap(_partition, 0, _partition->size,
+                                     PARTITION_MMAP_DATA, &ptr,
+                                     &_map_handle)) {
+      return NULL;
+    }
+    _map_ptr = (const uint8_t *)ptr;
+  }
+
+  return _map_ptr + addr;
+}
+
 #endif
@@ -34,6 +34,10 @@ private:
   esp_partition_t const *_partition;
   SPIFlash_Device_t _flash_device;
 
+  // whole partition is mapped on first map() until end()
+  const uint8_t *_map_ptr;
+  uint32_t _map_handle;
+
 public:
   Adafruit_FlashTransport_ESP32(void);
 
@@ -52,9 +56,11 @@ public:
   virtual bool readMemory(uint32_t addr, uint8_t *data, uint32_t len);
   virtual bool writeMemory(uint32_t addr, uint8_t const *data, uint32_t len);
 
+  virtual const uint8_t *map(uint32_t addr, uint32_t len);
+
   // Flash device is already detected and configured, get the pointer without
   // go through initial sequence
-  SPIFlash_Device_t *getFlashDevice(void);
+  virtual SPIFlash_Device_t *getFlashDevice(void);
 };
 
 #endif /* ADAFRUIT_FLASHTRANSPORT_ESP32_H_ */
@@ -69,6 +69,27 @@ typedef struct {
   // Fram does not need/support erase and has much simpler WRITE operation
   bool is_fram : 1;
 
+  // Supports erase/program suspend 0x75 and resume 0x7A. Reads can be served
+  // while a sector or block erase is in progress.
+  bool supports_suspend : 1;
+
+  // Supports the fast read quad I/O command 0xEB (1-4-4): address and mode
+  // bits on four lines, followed by 4 dummy cycles.
+  bool supports_quad_io : 1;
+
+  // Mode bits 0xA5 of 0xEB keep the device in continuous read mode: the
+  // opcode is skipped on the next read. Mode bits 0xFF exit it.
+  bool supports_continuous_read : 1;
+
+  // Opcode entering QPI (4-4-4) mode, where opcode and address also use four
+  // lines: 0x38 (Winbond, exit 0xFF) or 0x35 (Macronix, exit 0xF5). 0x00 if
+  // not supported.
+  uint8_t qpi_enter_command;
+
+  // Time to release from Deep Power-Down 0xB9 with 0xAB (tRES1). 0 if deep
+  // power-down is not supported.
+  uint8_t release_power_down_us;
+
 } SPIFlash_Device_t;
 
 // Settings for the Adesto Tech AT25DF081A 1MiB SPI flash. Its on the SAMD21
@@ -83,6 +104,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = false,                        \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 // Settings for the Adesto Tech AT25SF041 4MiB SPI flash used in AS7262 sensor
@@ -95,6 +120,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = false,                        \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 // Settings for the Gigadevice GD25Q16C 2MiB SPI flash.
@@ -110,6 +139,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 20,                                               \
   }
 
 // Settings for the Gigadevice GD25Q32C 4MiB SPI flash.
@@ -125,6 +158,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = true,         \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 20,                                               \
   }
 
 // Settings for the Gigadevice GD25Q64C 8MiB SPI flash.
@@ -141,6 +178,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = true,         \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 20,                                               \
   }
 
 // https://www.fujitsu.com/uk/Images/MB85RS64V.pdf
@@ -154,6 +195,10 @@ typedef struct {
     .supports_qspi = false, .supports_qspi_writes = false,                     \
     .write_status_register_split = false, .single_status_byte = true,          \
     .is_fram = true,                                                           \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 0,                                                \
   }
 
 // https://www.fujitsu.com/uk/Images/MB85RS1MT.pdf
@@ -167,6 +212,10 @@ typedef struct {
     .supports_qspi = false, .supports_qspi_writes = false,                     \
     .write_status_register_split = false, .single_status_byte = true,          \
     .is_fram = true,                                                           \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 0,                                                \
   }
 
 // https://www.fujitsu.com/uk/Images/MB85RS2MTA.pdf
@@ -180,6 +229,10 @@ typedef struct {
     .supports_qspi = false, .supports_qspi_writes = false,                     \
     .write_status_register_split = false, .single_status_byte = true,          \
     .is_fram = true,                                                           \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 0,                                                \
   }
 
 // https://www.fujitsu.com/uk/Images/MB85RS4MT.pdf
@@ -193,6 +246,10 @@ typedef struct {
     .supports_qspi = false, .supports_qspi_writes = true,                      \
     .write_status_register_split = false, .single_status_byte = true,          \
     .is_fram = true,                                                           \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 0,                                                \
   }
 
 // Settings for the Macronix MX25L1606 2MiB SPI flash.
@@ -206,6 +263,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = true, .is_fram = false,                              \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 10,                                               \
   }
 
 // Settings for the Macronix MX25R1635F 2MiB SPI flash.
@@ -222,6 +283,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = true, .is_fram = false,                              \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 35,                                               \
   }
 
 // Settings for the Macronix MX25L3233F 4MiB SPI flash.
@@ -236,6 +301,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = true, .is_fram = false,                              \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x35,                                                 \
+    .release_power_down_us = 10,                                               \
   }
 
 // Settings for the Macronix MX25L6433F 8MiB SPI flash.
@@ -250,6 +319,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = true, .is_fram = false,                              \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x35,                                                 \
+    .release_power_down_us = 10,                                               \
   }
 
 // Settings for the Macronix MX25R6435F 8MiB SPI flash.
@@ -266,6 +339,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = true, .is_fram = false,                              \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 35,                                               \
   }
 
 // Settings for the Macronix MX25L12833F 16MiB SPI flash.
@@ -280,6 +357,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = true, .is_fram = false,                              \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x35,                                                 \
+    .release_power_down_us = 10,                                               \
   }
 
 // Settings for the Cypress (was Spansion) S25FL064L 8MiB SPI flash.
@@ -293,6 +374,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 // Settings for the Cypress (was Spansion) S25FL116K 2MiB SPI flash.
@@ -306,6 +391,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 // Settings for the Cypress (was Spansion) S25FL216K 2MiB SPI flash.
@@ -319,6 +408,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = false,                        \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 // Settings for the Winbond W25Q80DL 1MiB SPI flash.
@@ -333,6 +426,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q80DV 1MiB SPI flash.
@@ -347,6 +444,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q16FW 2MiB SPI flash.
@@ -361,6 +462,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q16JV-IQ 2MiB SPI flash. Note that JV-IM has a
@@ -375,6 +480,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q16JV-IM 2MiB SPI flash. Note that JV-IQ has a
@@ -388,6 +497,10 @@ typedef struct {
     .quad_enable_bit_mask = 0x02, .has_sector_protection = false,              \
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x38,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q32BV 4MiB SPI flash.
@@ -402,6 +515,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q32FV 4MiB SPI flash.
@@ -415,6 +532,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = false,                        \
     .supports_qspi_writes = false, .write_status_register_split = false,       \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q32JV-IM 4MiB SPI flash.
@@ -427,6 +548,10 @@ typedef struct {
     .quad_enable_bit_mask = 0x02, .has_sector_protection = false,              \
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x38,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q32JV-IQ 4MiB SPI flash. Note that JV-IM has a
@@ -441,6 +566,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q64JV-IM 8MiB SPI flash. Note that JV-IQ has a
@@ -455,6 +584,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x38,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q64JV-IQ 8MiB SPI flash. Note that JV-IM has a
@@ -469,6 +602,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q128JV-SQ 16MiB SPI flash. Note that JV-IM has a
@@ -483,6 +620,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q128JV-PM 16MiB SPI flash. Note that JV-IM has a
@@ -497,6 +638,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x38,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Winbond W25Q256JV 32MiB SPI flash.
@@ -510,6 +655,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = true,                                                  \
+    .supports_quad_io = true, .supports_continuous_read = true,                \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 3,                                                \
   }
 
 // Settings for the Zetta Device ZD25WQ16B 2MiB SPI flash.
@@ -523,6 +672,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 // Settings for the Puya Semiconductor P25Q16H 2MiB QSPI flash.
@@ -537,6 +690,10 @@ typedef struct {
     .supports_fast_read = true, .supports_qspi = true,                         \
     .supports_qspi_writes = true, .write_status_register_split = false,        \
     .single_status_byte = false, .is_fram = false,                             \
+    .supports_suspend = false,                                                 \
+    .supports_quad_io = false, .supports_continuous_read = false,              \
+    .qpi_enter_command = 0x00,                                                 \
+    .release_power_down_us = 30,                                               \
   }
 
 #endif // MICROPY_INCLUDED_ATMEL_SAMD_EXTERNAL_FLASH_DEVICES_H
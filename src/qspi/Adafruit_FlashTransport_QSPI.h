@@ -40,6 +40,27 @@ public:
 
   virtual bool supportQuadMode(void) { return true; }
 
+  // nRF52 read/write tasks only use 3-byte address opcodes, device is put in
+  // 4-byte address mode instead
+  virtual bool support4ByteOpcodes(void) {
+#ifdef __SAMD51__
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // nRF52 always sends the opcode on a single line
+  virtual bool supportQpiMode(void) {
+#ifdef __SAMD51__
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  virtual bool supportPowerDown(void) { return true; }
+
   virtual void setClockSpeed(uint32_t write_hz, uint32_t read_hz);
 
   virtual bool runCommand(uint8_t command);
@@ -49,6 +70,13 @@ public:
   virtual bool eraseCommand(uint8_t command, uint32_t address);
   virtual bool readMemory(uint32_t addr, uint8_t *data, uint32_t len);
   virtual bool writeMemory(uint32_t addr, uint8_t const *data, uint32_t len);
+
+  virtual bool readSFDP(uint32_t addr, uint8_t *data, uint32_t len);
+
+#ifdef __SAMD51__
+  // Read through the QSPI AHB window
+  virtual const uint8_t *map(uint32_t addr, uint32_t len);
+#endif
 };
 
 #endif /* ADAFRUIT_FLASHTRANSPORT_QSPI_H_ */
@@ -54,6 +54,24 @@
 #define PIN_QSPI_IO3 -1
 #endif
 
+// Address length and read command are set after begin(), update address mode
+// and read opcode of the READ, WRITE and ERASE tasks accordingly. Device is in
+// 4-byte address mode for 32-bit. READ4IO does not support continuous read.
+static void set_ifconfig0(uint8_t addr_len, uint8_t cmd_read) {
+  uint32_t ifconfig0 = NRF_QSPI->IFCONFIG0;
+  ifconfig0 &= ~(QSPI_IFCONFIG0_ADDRMODE_Msk | QSPI_IFCONFIG0_READOC_Msk);
+
+  if (addr_len == 4) {
+    ifconfig0 |= QSPI_IFCONFIG0_ADDRMODE_Msk;
+  }
+
+  ifconfig0 |= ((cmd_read == SFLASH_CMD_QUAD_IO_READ) ? NRF_QSPI_READOC_READ4IO
+                                                       : NRF_QSPI_READOC_READ4O)
+               << QSPI_IFCONFIG0_READOC_Pos;
+
+  NRF_QSPI->IFCONFIG0 = ifconfig0;
+}
+
 Adafruit_FlashTransport_QSPI::Adafruit_FlashTransport_QSPI(void)
     : Adafruit_FlashTransport_QSPI(PIN_QSPI_SCK, PIN_QSPI_CS, PIN_QSPI_IO0,
                                    PIN_QSPI_IO1, PIN_QSPI_IO2, PIN_QSPI_IO3) {}
@@ -61,6 +79,8 @@ Adafruit_FlashTransport_QSPI::Adafruit_FlashTransport_QSPI(void)
 Adafruit_FlashTransport_QSPI::Adafruit_FlashTransport_QSPI(
     int8_t sck, int8_t cs, int8_t io0, int8_t io1, int8_t io2, int8_t io3) {
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
   _cmd_read = SFLASH_CMD_QUAD_READ;
   _sck = sck;
   _cs = cs;
@@ -173,13 +193,58 @@ bool Adafruit_FlashTransport_QSPI::eraseCommand(uint8_t command,
     erase_len = NRF_QSPI_ERASE_LEN_4KB;
   } else if (command == SFLASH_CMD_ERASE_BLOCK) {
     erase_len = NRF_QSPI_ERASE_LEN_64KB;
+  } else if (command == SFLASH_CMD_ERASE_BLOCK32) {
+    // ERASE task has no 32KB length, use custom instruction with 24-bit
+    // address. Write enable is issued by caller.
+    nrf_qspi_cinstr_conf_t cinstr_cfg = {.opcode = command,
+                                         .length = NRF_QSPI_CINSTR_LEN_4B,
+                                         .io2_level = true,
+                                         .io3_level = true,
+                                         .wipwait = false,
+                                         .wren = false};
+    uint8_t const addr_buf[3] = {(uint8_t)(address >> 16),
+                                 (uint8_t)(address >> 8), (uint8_t)address};
+
+    return nrfx_qspi_cinstr_xfer(&cinstr_cfg, addr_buf, NULL) == NRFX_SUCCESS;
   } else {
     return false;
   }
 
+  set_ifconfig0(_addr_len, _cmd_read);
   return NRFX_SUCCESS == nrfx_qspi_erase(erase_len, address);
 }
 
+bool Adafruit_FlashTransport_QSPI::readSFDP(uint32_t addr, uint8_t *data,
+                                            uint32_t len) {
+  // Custom instruction transfers up to 8 bytes after opcode: 3 address bytes,
+  // 1 dummy byte then 4 bytes of data
+  nrf_qspi_cinstr_conf_t cinstr_cfg = {.opcode = SFLASH_CMD_READ_SFDP,
+                                       .length = NRF_QSPI_CINSTR_LEN_9B,
+                                       .io2_level = true,
+                                       .io3_level = true,
+                                       .wipwait = false,
+                                       .wren = false};
+
+  while (len) {
+    uint8_t const tx[8] = {(uint8_t)(addr >> 16), (uint8_t)(addr >> 8),
+                           (uint8_t)addr, 0xFF};
+    uint8_t rx[8];
+
+    if (nrfx_qspi_cinstr_xfer(&cinstr_cfg, tx, rx) != NRFX_SUCCESS) {
+      return false;
+    }
+
+    uint32_t const count = min(len, (uint32_t)4);
+    memcpy(data, rx + 4, count);
+
+    data += count;
+    addr += count;
+    len -= count;
+  }
+
+  return true;
+}
+
 //--------------------------------------------------------------------+
 // Read & Write
 //--------------------------------------------------------------------+
@@ -255,12 +320,14 @@ static bool read_write_memory(bool read_op, uint32_t addr, uint8_t *data,
 
 bool Adafruit_FlashTransport_QSPI::readMemory(uint32_t addr, uint8_t *data,
                                               uint32_t len) {
+  set_ifconfig0(_addr_len, _cmd_read);
   return read_write_memory(true, addr, data, len);
 }
 
 bool Adafruit_FlashTransport_QSPI::writeMemory(uint32_t addr,
                                                uint8_t const *data,
                                                uint32_t len) {
+  set_ifconfig0(_addr_len, _cmd_read);
   return read_write_memory(false, addr, (uint8_t *)data, len);
 }
 
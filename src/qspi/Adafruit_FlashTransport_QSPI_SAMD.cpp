@@ -30,6 +30,36 @@
 static void _run_instruction(uint8_t command, uint32_t iframe, uint32_t addr,
                              uint8_t *buffer, uint32_t size);
 
+// Command 0x6B 1 line address, 4 line Data used by map()
+// Quad output mode, read memory type
+#define QSPI_IFRAME_QUAD_READ                                                  \
+  (QSPI_INSTRFRAME_WIDTH_QUAD_OUTPUT | QSPI_INSTRFRAME_ADDRLEN_24BITS |        \
+   QSPI_INSTRFRAME_TFRTYPE_READMEMORY | QSPI_INSTRFRAME_INSTREN |              \
+   QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_DATAEN |                           \
+   QSPI_INSTRFRAME_DUMMYLEN(8))
+
+// Command 0xEB with opcode, address, mode bits and data on 4 lines used by
+// map() in QPI mode
+#define QSPI_IFRAME_QPI_READ                                                   \
+  (QSPI_INSTRFRAME_WIDTH_QUAD_CMD | QSPI_INSTRFRAME_ADDRLEN_24BITS |           \
+   QSPI_INSTRFRAME_TFRTYPE_READMEMORY | QSPI_INSTRFRAME_INSTREN |              \
+   QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_OPTCODEEN |                        \
+   QSPI_INSTRFRAME_OPTCODELEN_8BITS | QSPI_INSTRFRAME_DATAEN |                 \
+   QSPI_INSTRFRAME_DUMMYLEN(4))
+
+// AHB window is mapped by map(): it must be left in read memory mode
+static bool _mapped = false;
+
+// Mode bits of Quad I/O read 0xEB
+enum {
+  QSPI_MODE_CONTINUOUS = 0xA5, // stay in continuous read mode
+  QSPI_MODE_EXIT = 0xFF,       // exit continuous read mode
+};
+
+// Device is in continuous read mode: next transfer must be 0xEB without
+// opcode, anything else would be taken as an address.
+static bool _cont_active = false;
+
 // Turn off cache and invalidate all data in it.
 static void samd_peripherals_disable_and_clear_cache(void) {
   CMCC->CTRL.bit.CEN = 0;
@@ -41,6 +71,61 @@ static void samd_peripherals_disable_and_clear_cache(void) {
 // Enable cache
 static void samd_peripherals_enable_cache(void) { CMCC->CTRL.bit.CEN = 1; }
 
+// Width of command frames: opcode on 1 line, or on 4 lines in QPI mode
+static inline uint32_t samd_cmd_width(bool qpi) {
+  return qpi ? QSPI_INSTRFRAME_WIDTH_QUAD_CMD
+             : QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI;
+}
+
+// Restore read memory mode of the AHB window after another instruction, and
+// drop cached contents that may have been erased or programmed.
+static void samd_restore_map(bool qpi) {
+  if (!_mapped) {
+    return;
+  }
+
+  samd_peripherals_disable_and_clear_cache();
+
+  // 0x6B is not available in QPI mode
+  if (qpi) {
+    QSPI->INSTRCTRL.reg = QSPI_INSTRCTRL_INSTR(SFLASH_CMD_QUAD_IO_READ) |
+                          QSPI_INSTRCTRL_OPTCODE(QSPI_MODE_EXIT);
+    QSPI->INSTRFRAME.reg = QSPI_IFRAME_QPI_READ;
+  } else {
+    QSPI->INSTRCTRL.bit.INSTR = SFLASH_CMD_QUAD_READ;
+    QSPI->INSTRFRAME.reg = QSPI_IFRAME_QUAD_READ;
+  }
+  volatile uint32_t dummy = QSPI->INSTRFRAME.reg;
+  (void)dummy;
+
+  samd_peripherals_enable_cache();
+}
+
+// Make device exit continuous read mode before any other instruction: read
+// without opcode and with mode bits 0xFF. Address is all ones as well, which a
+// device not in continuous read mode takes as unknown opcode 0xFF.
+static void samd_exit_continuous_read(uint8_t addr_len, bool qpi) {
+  if (!_cont_active) {
+    return;
+  }
+  _cont_active = false;
+
+  uint32_t iframe =
+      (qpi ? QSPI_INSTRFRAME_WIDTH_QUAD_CMD : QSPI_INSTRFRAME_WIDTH_QUAD_IO) |
+      QSPI_INSTRFRAME_TFRTYPE_READ | QSPI_INSTRFRAME_ADDREN |
+      QSPI_INSTRFRAME_OPTCODEEN | QSPI_INSTRFRAME_OPTCODELEN_8BITS |
+      QSPI_INSTRFRAME_DATAEN | QSPI_INSTRFRAME_DUMMYLEN(4) |
+      (addr_len == 4 ? QSPI_INSTRFRAME_ADDRLEN_32BITS
+                     : QSPI_INSTRFRAME_ADDRLEN_24BITS);
+  uint8_t data;
+
+  QSPI->INSTRCTRL.bit.OPTCODE = QSPI_MODE_EXIT;
+
+  samd_peripherals_disable_and_clear_cache();
+  _run_instruction(SFLASH_CMD_QUAD_IO_READ, iframe, 0xFFFFFFFF, &data, 1);
+  samd_peripherals_enable_cache();
+}
+
 Adafruit_FlashTransport_QSPI::Adafruit_FlashTransport_QSPI(void)
     : Adafruit_FlashTransport_QSPI(PIN_QSPI_SCK, PIN_QSPI_CS, PIN_QSPI_IO0,
                                    PIN_QSPI_IO1, PIN_QSPI_IO2, PIN_QSPI_IO3) {}
@@ -48,6 +133,8 @@ Adafruit_FlashTransport_QSPI::Adafruit_FlashTransport_QSPI(void)
 Adafruit_FlashTransport_QSPI::Adafruit_FlashTransport_QSPI(
     int8_t sck, int8_t cs, int8_t io0, int8_t io1, int8_t io2, int8_t io3) {
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
   _cmd_read = SFLASH_CMD_QUAD_READ;
   _sck = sck;
   _cs = cs;
@@ -78,9 +165,29 @@ void Adafruit_FlashTransport_QSPI::begin(void) {
                     QSPI_CTRLB_CSMODE_LASTXFER;
 
   QSPI->CTRLA.bit.ENABLE = 1;
+
+  // Device may still be in continuous read mode e.g after MCU reset. 16 clocks
+  // with IO0 high make it exit, otherwise it is an unknown command.
+  uint8_t const ff = 0xFF;
+  _cont_active = false;
+  _qpi = false;
+  writeCommand(SFLASH_CMD_CONTINUOUS_READ_RESET, &ff, 1);
+
+  // Or in QPI mode, possibly in continuous read mode as well. Exit commands of
+  // both Winbond and Macronix are sent on 4 lines, a device in SPI mode only
+  // sees 2 clocks and ignores them.
+  _cont_active = true;
+  samd_exit_continuous_read(4, true);
+
+  _qpi = true;
+  runCommand(SFLASH_CMD_EXIT_QPI);
+  runCommand(SFLASH_CMD_EXIT_QPI_MX);
+  _qpi = false;
 }
 
 void Adafruit_FlashTransport_QSPI::end(void) {
+  samd_exit_continuous_read(_addr_len, _qpi);
+  _mapped = false;
   QSPI->CTRLA.bit.ENABLE = 0;
 
   MCLK->APBCMASK.bit.QSPI_ = false;
@@ -89,25 +196,29 @@ void Adafruit_FlashTransport_QSPI::end(void) {
 }
 
 bool Adafruit_FlashTransport_QSPI::runCommand(uint8_t command) {
-  uint32_t iframe = QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI |
-                    QSPI_INSTRFRAME_ADDRLEN_24BITS |
+  samd_exit_continuous_read(_addr_len, _qpi);
+
+  uint32_t iframe = samd_cmd_width(_qpi) | QSPI_INSTRFRAME_ADDRLEN_24BITS |
                     QSPI_INSTRFRAME_TFRTYPE_READ | QSPI_INSTRFRAME_INSTREN;
 
   _run_instruction(command, iframe, 0, NULL, 0);
+  samd_restore_map(_qpi);
   return true;
 }
 
 bool Adafruit_FlashTransport_QSPI::readCommand(uint8_t command,
                                                uint8_t *response,
                                                uint32_t len) {
-  uint32_t iframe = QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI |
-                    QSPI_INSTRFRAME_ADDRLEN_24BITS |
+  samd_exit_continuous_read(_addr_len, _qpi);
+
+  uint32_t iframe = samd_cmd_width(_qpi) | QSPI_INSTRFRAME_ADDRLEN_24BITS |
                     QSPI_INSTRFRAME_TFRTYPE_READ | QSPI_INSTRFRAME_INSTREN |
                     QSPI_INSTRFRAME_DATAEN;
 
   samd_peripherals_disable_and_clear_cache();
   _run_instruction(command, iframe, 0, response, len);
   samd_peripherals_enable_cache();
+  samd_restore_map(_qpi);
 
   return true;
 }
@@ -115,63 +226,158 @@ bool Adafruit_FlashTransport_QSPI::readCommand(uint8_t command,
 bool Adafruit_FlashTransport_QSPI::writeCommand(uint8_t command,
                                                 uint8_t const *data,
                                                 uint32_t len) {
-  uint32_t iframe = QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI |
-                    QSPI_INSTRFRAME_ADDRLEN_24BITS |
+  samd_exit_continuous_read(_addr_len, _qpi);
+
+  uint32_t iframe = samd_cmd_width(_qpi) | QSPI_INSTRFRAME_ADDRLEN_24BITS |
                     QSPI_INSTRFRAME_TFRTYPE_WRITE | QSPI_INSTRFRAME_INSTREN |
                     (data != NULL ? QSPI_INSTRFRAME_DATAEN : 0);
 
   samd_peripherals_disable_and_clear_cache();
   _run_instruction(command, iframe, 0, (uint8_t *)data, len);
   samd_peripherals_enable_cache();
+  samd_restore_map(_qpi);
 
   return true;
 }
 
 bool Adafruit_FlashTransport_QSPI::eraseCommand(uint8_t command,
                                                 uint32_t address) {
+  samd_exit_continuous_read(_addr_len, _qpi);
+
   // Sector Erase
-  uint32_t iframe = QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI |
-                    QSPI_INSTRFRAME_ADDRLEN_24BITS |
+  uint32_t iframe = samd_cmd_width(_qpi) |
+                    (_addr_len == 4 ? QSPI_INSTRFRAME_ADDRLEN_32BITS
+                                    : QSPI_INSTRFRAME_ADDRLEN_24BITS) |
                     QSPI_INSTRFRAME_TFRTYPE_WRITE | QSPI_INSTRFRAME_INSTREN |
                     QSPI_INSTRFRAME_ADDREN;
 
-  _run_instruction(command, iframe, address, NULL, 0);
+  _run_instruction(addressCommand(command), iframe, address, NULL, 0);
+  samd_restore_map(_qpi);
   return true;
 }
 
 bool Adafruit_FlashTransport_QSPI::readMemory(uint32_t addr, uint8_t *data,
                                               uint32_t len) {
-  // Command 0x6B 1 line address, 4 line Data
-  // Quad output mode, read memory type
-  uint32_t iframe = QSPI_INSTRFRAME_WIDTH_QUAD_OUTPUT |
-                    QSPI_INSTRFRAME_ADDRLEN_24BITS |
-                    QSPI_INSTRFRAME_TFRTYPE_READMEMORY |
-                    QSPI_INSTRFRAME_INSTREN | QSPI_INSTRFRAME_ADDREN |
-                    QSPI_INSTRFRAME_DATAEN | QSPI_INSTRFRAME_DUMMYLEN(8);
+  uint32_t iframe;
+
+  if (_cmd_read == SFLASH_CMD_QUAD_IO_READ) {
+    // Command 0xEB 1 line opcode (4 lines in QPI mode), 4 line address, mode
+    // bits and data. Opcode is skipped while device is in continuous read mode.
+    iframe = (_qpi ? QSPI_INSTRFRAME_WIDTH_QUAD_CMD
+                   : QSPI_INSTRFRAME_WIDTH_QUAD_IO) |
+             QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_OPTCODEEN |
+             QSPI_INSTRFRAME_OPTCODELEN_8BITS | QSPI_INSTRFRAME_DATAEN |
+             QSPI_INSTRFRAME_DUMMYLEN(4);
+
+    if (!_cont_active) {
+      iframe |= QSPI_INSTRFRAME_INSTREN;
+    }
+
+    QSPI->INSTRCTRL.bit.OPTCODE =
+        _cont_read ? QSPI_MODE_CONTINUOUS : QSPI_MODE_EXIT;
+    _cont_active = _cont_read;
+  } else {
+    // Command 0x6B 1 line address, 4 line Data
+    iframe = QSPI_INSTRFRAME_WIDTH_QUAD_OUTPUT | QSPI_INSTRFRAME_INSTREN |
+             QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_DATAEN |
+             QSPI_INSTRFRAME_DUMMYLEN(8);
+  }
+
+  // AHB window only covers 24-bit address: with 32-bit address the address is
+  // sent from INSTRADDR and data is streamed through the start of the window
+  if (_addr_len == 4) {
+    iframe |= QSPI_INSTRFRAME_ADDRLEN_32BITS | QSPI_INSTRFRAME_TFRTYPE_READ;
+  } else {
+    iframe |=
+        QSPI_INSTRFRAME_ADDRLEN_24BITS | QSPI_INSTRFRAME_TFRTYPE_READMEMORY;
+  }
 
   samd_peripherals_disable_and_clear_cache();
-  _run_instruction(SFLASH_CMD_QUAD_READ, iframe, addr, data, len);
+  _run_instruction(addressCommand(_cmd_read), iframe, addr, data, len);
   samd_peripherals_enable_cache();
 
+  // mapped window can't be left with a 32-bit address frame, nor in
+  // continuous read mode: CPU reads would send the 0xEB frame with opcode
+  if (_mapped) {
+    samd_exit_continuous_read(_addr_len, _qpi);
+    samd_restore_map(_qpi);
+  }
+
   return true;
 }
 
 bool Adafruit_FlashTransport_QSPI::writeMemory(uint32_t addr,
                                                uint8_t const *data,
                                                uint32_t len) {
-  uint32_t iframe =
-      QSPI_INSTRFRAME_WIDTH_QUAD_OUTPUT | QSPI_INSTRFRAME_ADDRLEN_24BITS |
-      QSPI_INSTRFRAME_TFRTYPE_WRITEMEMORY | QSPI_INSTRFRAME_INSTREN |
-      QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_DATAEN;
+  samd_exit_continuous_read(_addr_len, _qpi);
+
+  // Command 0x32 1 line address, 4 line data. There is no 0x32 in QPI mode,
+  // page program 0x02 is sent on 4 lines instead.
+  uint8_t const command =
+      _qpi ? SFLASH_CMD_PAGE_PROGRAM : SFLASH_CMD_QUAD_PAGE_PROGRAM;
+  uint32_t const width =
+      _qpi ? QSPI_INSTRFRAME_WIDTH_QUAD_CMD : QSPI_INSTRFRAME_WIDTH_QUAD_OUTPUT;
+
+  uint32_t iframe = width | QSPI_INSTRFRAME_ADDRLEN_24BITS |
+                    QSPI_INSTRFRAME_TFRTYPE_WRITEMEMORY |
+                    QSPI_INSTRFRAME_INSTREN | QSPI_INSTRFRAME_ADDREN |
+                    QSPI_INSTRFRAME_DATAEN;
+
+  // same as readMemory(), address is sent from INSTRADDR
+  if (_addr_len == 4) {
+    iframe = width | QSPI_INSTRFRAME_ADDRLEN_32BITS |
+             QSPI_INSTRFRAME_TFRTYPE_WRITE | QSPI_INSTRFRAME_INSTREN |
+             QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_DATAEN;
+  }
 
   samd_peripherals_disable_and_clear_cache();
-  _run_instruction(SFLASH_CMD_QUAD_PAGE_PROGRAM, iframe, addr, (uint8_t *)data,
+  _run_instruction(addressCommand(command), iframe, addr, (uint8_t *)data,
                    len);
   samd_peripherals_enable_cache();
+  samd_restore_map(_qpi);
+
+  return true;
+}
+
+bool Adafruit_FlashTransport_QSPI::readSFDP(uint32_t addr, uint8_t *data,
+                                            uint32_t len) {
+  // Only read in SPI mode by begin()
+  if (_qpi) {
+    return false;
+  }
+
+  samd_exit_continuous_read(_addr_len, _qpi);
+
+  // Single line, always 24-bit address and 8 dummy cycles
+  uint32_t iframe = QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI |
+                    QSPI_INSTRFRAME_ADDRLEN_24BITS |
+                    QSPI_INSTRFRAME_TFRTYPE_READMEMORY |
+                    QSPI_INSTRFRAME_INSTREN | QSPI_INSTRFRAME_ADDREN |
+                    QSPI_INSTRFRAME_DATAEN | QSPI_INSTRFRAME_DUMMYLEN(8);
+
+  samd_peripherals_disable_and_clear_cache();
+  _run_instruction(SFLASH_CMD_READ_SFDP, iframe, addr, data, len);
+  samd_peripherals_enable_cache();
+  samd_restore_map(_qpi);
 
   return true;
 }
 
+const uint8_t *Adafruit_FlashTransport_QSPI::map(uint32_t addr,
+                                                 uint32_t len) {
+  samd_exit_continuous_read(_addr_len, _qpi);
+
+  // AHB window only covers 24-bit address
+  if (addr > 0x1000000UL || len > 0x1000000UL - addr) {
+    return NULL;
+  }
+
+  _mapped = true;
+  samd_restore_map(_qpi);
+
+  return (const uint8_t *)(QSPI_AHB + addr);
+}
+
 /**************************************************************************/
 /*!
  @brief set the clock speed
@@ -199,7 +405,14 @@ void Adafruit_FlashTransport_QSPI::setClockSpeed(uint32_t clock_hz,
 /**************************************************************************/
 static void _run_instruction(uint8_t command, uint32_t iframe, uint32_t addr,
                              uint8_t *buffer, uint32_t size) {
-  if (command == SFLASH_CMD_ERASE_SECTOR || command == SFLASH_CMD_ERASE_BLOCK) {
+  uint32_t const tfr_type = iframe & QSPI_INSTRFRAME_TFRTYPE_Msk;
+
+  // Memory transfers take address from the AHB access, others (e.g erase or
+  // 32-bit address) from INSTRADDR
+  bool const mem_tfr = (tfr_type == QSPI_INSTRFRAME_TFRTYPE_READMEMORY) ||
+                       (tfr_type == QSPI_INSTRFRAME_TFRTYPE_WRITEMEMORY);
+
+  if ((iframe & QSPI_INSTRFRAME_ADDREN) && !mem_tfr) {
     QSPI->INSTRADDR.reg = addr;
   }
 
@@ -213,8 +426,7 @@ static void _run_instruction(uint8_t command, uint32_t iframe, uint32_t addr,
   (void)dummy;
 
   if (buffer && size) {
-    uint8_t *qspi_mem = (uint8_t *)(QSPI_AHB + addr);
-    uint32_t const tfr_type = iframe & QSPI_INSTRFRAME_TFRTYPE_Msk;
+    uint8_t *qspi_mem = (uint8_t *)(QSPI_AHB + (mem_tfr ? addr : 0));
 
     if ((tfr_type == QSPI_INSTRFRAME_TFRTYPE_READ) ||
         (tfr_type == QSPI_INSTRFRAME_TFRTYPE_READMEMORY)) {
@@ -67,6 +67,8 @@ Adafruit_FlashTransport_RP2040::Adafruit_FlashTransport_RP2040(
     : _idle_other_core_on_write(idle) {
   _cmd_read = SFLASH_CMD_READ;
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
 
   _start_addr = start_addr;
   _size = size;
@@ -108,6 +110,8 @@ void Adafruit_FlashTransport_RP2040::begin(void) {
 void Adafruit_FlashTransport_RP2040::end(void) {
   _cmd_read = SFLASH_CMD_READ;
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
 }
 
 SPIFlash_Device_t *Adafruit_FlashTransport_RP2040::getFlashDevice(void) {
@@ -168,6 +172,8 @@ bool Adafruit_FlashTransport_RP2040::eraseCommand(uint8_t command,
 
   if (command == SFLASH_CMD_ERASE_SECTOR) {
     erase_sz = SFLASH_SECTOR_SIZE;
+  } else if (command == SFLASH_CMD_ERASE_BLOCK32) {
+    erase_sz = SFLASH_BLOCK32_SIZE;
   } else if (command == SFLASH_CMD_ERASE_BLOCK) {
     erase_sz = SFLASH_BLOCK_SIZE;
   } else {
@@ -208,4 +214,14 @@ bool Adafruit_FlashTransport_RP2040::writeMemory(uint32_t addr,
   return true;
 }
 
+const uint8_t *Adafruit_FlashTransport_RP2040::map(uint32_t addr,
+                                                   uint32_t len) {
+  if (!check_addr(addr) || len > _size - addr) {
+    return NULL;
+  }
+
+  // flash_range_erase() and flash_range_program() flush the XIP cache
+  return (const uint8_t *)(XIP_BASE + _start_addr + addr);
+}
+
 #endif
@@ -74,9 +74,11 @@ public:
   virtual bool readMemory(uint32_t addr, uint8_t *data, uint32_t len);
   virtual bool writeMemory(uint32_t addr, uint8_t const *data, uint32_t len);
 
+  virtual const uint8_t *map(uint32_t addr, uint32_t len);
+
   // Flash device is already detected and configured, get the pointer without
   // go through initial sequence
-  SPIFlash_Device_t *getFlashDevice(void);
+  virtual SPIFlash_Device_t *getFlashDevice(void);
 };
 
 class Adafruit_FlashTransport_RP2040_CPY
@@ -0,0 +1,889 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_FlashTransport.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+enum {
+  SR_WIP = 0x01,
+  SR_WEL = 0x02,
+  SR2_SUS = 0x80,
+};
+
+static const SPIFlash_SimTiming_t default_timing = {
+    .page_program_us = 700,
+    .sector_erase_us = 45000,
+    .block32_erase_us = 120000,
+    .block_erase_us = 150000,
+    .chip_erase_ms_per_mb = 2500,
+    .write_status_us = 10000,
+    .suspend_us = 20,
+    .transaction_ns = 500,
+};
+
+Adafruit_FlashTransport_Sim::Adafruit_FlashTransport_Sim(
+    SPIFlash_Device_t const *device, uint8_t *buffer, bool quad) {
+  _cmd_read = quad ? SFLASH_CMD_QUAD_READ : SFLASH_CMD_READ;
+  _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
+
+  _dev = device;
+  _mem = buffer;
+  _mem_owned = false;
+  _quad = quad;
+
+#if defined(__linux__)
+  _image_path = NULL;
+  _fd = -1;
+#endif
+
+  _sr1 = _sr2 = 0;
+  _wel = false;
+  _reset_enabled = false;
+  _addr4 = false;
+  _cont_active = false;
+  _qpi_active = false;
+  _read_params = 0;
+  _power_down = false;
+
+  _clock_wr = _clock_rd = 4000000;
+  _now_ns = 0;
+  _busy_until_ns = 0;
+  _same_transaction = false;
+
+  _op_addr = _op_len = 0;
+  _suspended = false;
+  _suspended_ns = 0;
+
+  _timing = default_timing;
+  resetStats();
+}
+
+Adafruit_FlashTransport_Sim::~Adafruit_FlashTransport_Sim() {
+  if (!_mem_owned) {
+    return;
+  }
+
+#if defined(__linux__)
+  if (_fd >= 0) {
+    munmap(_mem, _dev->total_size);
+    close(_fd);
+    return;
+  }
+#endif
+
+  free(_mem);
+}
+
+void Adafruit_FlashTransport_Sim::begin(void) {
+  // Device may still be in QPI mode e.g after a simulated MCU reset. Same as
+  // the QSPI transport, exit commands are sent on 4 lines.
+  if (_quad) {
+    _qpi = true;
+    runCommand(SFLASH_CMD_EXIT_QPI);
+    runCommand(SFLASH_CMD_EXIT_QPI_MX);
+  }
+  _qpi = false;
+
+  if (_mem) {
+    return;
+  }
+
+  uint32_t const size = _dev->total_size;
+
+#if defined(__linux__)
+  if (_image_path) {
+    _fd = open(_image_path, O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+      return;
+    }
+
+    struct stat st;
+    fstat(_fd, &st);
+
+    uint32_t const old_size = (uint32_t)st.st_size;
+    if (old_size < size && ftruncate(_fd, size) != 0) {
+      close(_fd);
+      _fd = -1;
+      return;
+    }
+
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (mem == MAP_FAILED) {
+      close(_fd);
+      _fd = -1;
+      return;
+    }
+
+    _mem = (uint8_t *)mem;
+    _mem_owned = true;
+
+    // newly created part of the image is in erased state
+    if (old_size < size) {
+      memset(_mem + old_size, 0xff, size - old_size);
+    }
+    return;
+  }
+#endif
+
+  _mem = (uint8_t *)malloc(size);
+  if (_mem) {
+    _mem_owned = true;
+    memset(_mem, 0xff, size);
+  }
+}
+
+void Adafruit_FlashTransport_Sim::end(void) {
+  // contents are non-volatile, only flush the image file if any
+#if defined(__linux__)
+  if (_fd >= 0) {
+    msync(_mem, _dev->total_size, MS_SYNC);
+  }
+#endif
+}
+
+void Adafruit_FlashTransport_Sim::setClockSpeed(uint32_t write_hz,
+                                                uint32_t read_hz) {
+  _clock_wr = write_hz;
+  _clock_rd = read_hz;
+}
+
+void Adafruit_FlashTransport_Sim::resetStats(void) {
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+//--------------------------------------------------------------------+
+// Internal
+//--------------------------------------------------------------------+
+
+// Advance virtual time by the cost of one transaction: single_bits are clocked
+// on 1 line (command, address, dummy), data_bits on data_lines lines.
+void Adafruit_FlashTransport_Sim::bus(uint32_t clock_hz, uint32_t single_bits,
+                                      uint32_t data_bits, uint8_t data_lines) {
+  uint64_t const cycles =
+      single_bits + (data_bits + data_lines - 1) / data_lines;
+
+  _now_ns += (_same_transaction ? 0 : _timing.transaction_ns) +
+             (cycles * 1000000000ULL) / clock_hz;
+  _same_transaction = false;
+  _stats.commands++;
+}
+
+bool Adafruit_FlashTransport_Sim::quadEnabled(void) {
+  uint8_t const status = _dev->single_status_byte ? _sr1 : _sr2;
+  return _dev->quad_enable_bit_mask &&
+         (status & _dev->quad_enable_bit_mask) != 0;
+}
+
+// Address as seen by the device, invalid if the host sends a different
+// number of address bytes than the device expects for the command.
+uint32_t Adafruit_FlashTransport_Sim::maskAddress(uint32_t addr,
+                                                  uint8_t command) {
+  bool const addr4_cmd = (command == SFLASH_CMD_READ_4B) ||
+                         (command == SFLASH_CMD_FAST_READ_4B) ||
+                         (command == SFLASH_CMD_QUAD_READ_4B) ||
+                         (command == SFLASH_CMD_QUAD_IO_READ_4B) ||
+                         (command == SFLASH_CMD_PAGE_PROGRAM_4B) ||
+                         (command == SFLASH_CMD_QUAD_PAGE_PROGRAM_4B) ||
+                         (command == SFLASH_CMD_ERASE_SECTOR_4B) ||
+                         (command == SFLASH_CMD_ERASE_BLOCK_4B);
+
+  uint8_t dev_addr_len = 2;
+  if (_dev->total_size > 64UL * 1024) {
+    dev_addr_len = (_addr4 || addr4_cmd) ? 4 : 3;
+  }
+
+  if (_addr_len != dev_addr_len) {
+    return 0xFFFFFFFF;
+  }
+
+  if (_addr_len < 4) {
+    addr &= (1UL << (8 * _addr_len)) - 1;
+  }
+
+  return addr % _dev->total_size;
+}
+
+// Any command but 0xEB is first preceded by a read with mode bits 0xFF and no
+// opcode to exit continuous read mode
+void Adafruit_FlashTransport_Sim::exitContinuousRead(void) {
+  if (_cont_active) {
+    bus(_clock_rd, 2 * _addr_len + 2 + 4, 8, 4);
+    _cont_active = false;
+  }
+}
+
+// Latch WEL and make device busy for the duration of the operation. Erase and
+// program pass their address range, which makes them suspendable.
+bool Adafruit_FlashTransport_Sim::startOperation(uint64_t duration_ns,
+                                                 uint32_t addr, uint32_t len) {
+  // nothing but reads can be done while an operation is suspended
+  if (!_wel || _suspended) {
+    return false;
+  }
+
+  _wel = false;
+  if (!_dev->is_fram) {
+    _busy_until_ns = _now_ns + duration_ns;
+    _op_addr = addr;
+    _op_len = _dev->supports_suspend ? len : 0;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Commands
+//--------------------------------------------------------------------+
+
+bool Adafruit_FlashTransport_Sim::runCommand(uint8_t command) {
+  exitContinuousRead();
+
+  bus(_clock_wr, 0, 8, cmdLines());
+
+  // Opcode sent with the other width is garbage to the device, which ignores
+  // it
+  if (_qpi != _qpi_active) {
+    return false;
+  }
+
+  // Nothing but the release command is accepted in deep power-down
+  if (_power_down) {
+    if (command != SFLASH_CMD_RELEASE_POWER_DOWN) {
+      _stats.errors++;
+      return false;
+    }
+
+    _power_down = false;
+    return true;
+  }
+
+  // Only reset and suspend are accepted while an operation is in progress
+  if (isBusy() && command != SFLASH_CMD_ENABLE_RESET &&
+      command != SFLASH_CMD_RESET && command != SFLASH_CMD_SUSPEND) {
+    _stats.errors++;
+    return false;
+  }
+
+  bool const reset_enabled = _reset_enabled;
+  _reset_enabled = false;
+
+  switch (command) {
+  case SFLASH_CMD_WRITE_ENABLE:
+    _wel = true;
+    return true;
+
+  case SFLASH_CMD_WRITE_DISABLE:
+    _wel = false;
+    return true;
+
+  case SFLASH_CMD_ENABLE_RESET:
+    _reset_enabled = true;
+    return true;
+
+  case SFLASH_CMD_RESET:
+    if (!reset_enabled) {
+      break;
+    }
+
+    // abort any operation in progress and back to default address and SPI
+    // mode
+    _wel = false;
+    _addr4 = false;
+    _suspended = false;
+    _qpi_active = false;
+    _read_params = 0;
+    _busy_until_ns = _now_ns;
+    return true;
+
+  case SFLASH_CMD_SUSPEND:
+    if (!_dev->supports_suspend) {
+      break;
+    }
+
+    // ignored if there is nothing to suspend e.g operation just completed
+    if (isBusy() && _op_len && !_suspended) {
+      _suspended_ns = _busy_until_ns - _now_ns;
+      _busy_until_ns = _now_ns + (uint64_t)_timing.suspend_us * 1000;
+      _suspended = true;
+      _stats.suspends++;
+    }
+    return true;
+
+  case SFLASH_CMD_RESUME:
+    if (!_dev->supports_suspend) {
+      break;
+    }
+
+    if (_suspended) {
+      _busy_until_ns = _now_ns + _suspended_ns;
+      _suspended = false;
+    }
+    return true;
+
+  case SFLASH_CMD_ERASE_CHIP: {
+    uint64_t const tce_ns = (uint64_t)_timing.chip_erase_ms_per_mb *
+                            1000000ULL * _dev->total_size / (1024UL * 1024);
+
+    if (!_mem || _dev->is_fram || !startOperation(tce_ns)) {
+      break;
+    }
+
+    memset(_mem, 0xff, _dev->total_size);
+    _stats.chip_erases++;
+    return true;
+  }
+
+  case SFLASH_CMD_4_BYTE_ADDR:
+    _addr4 = true;
+    return true;
+
+  case SFLASH_CMD_POWER_DOWN:
+    if (!_dev->release_power_down_us) {
+      break;
+    }
+    _power_down = true;
+    _stats.power_downs++;
+    return true;
+
+  case SFLASH_CMD_RELEASE_POWER_DOWN:
+    // not in deep power-down, nothing to do
+    return true;
+
+  case SFLASH_CMD_3_BYTE_ADDR:
+    _addr4 = false;
+    return true;
+
+  case SFLASH_CMD_ENTER_QPI:
+  case SFLASH_CMD_ENTER_QPI_MX:
+    // Quad Enable bit must be set first
+    if (command != _dev->qpi_enter_command || !quadEnabled()) {
+      break;
+    }
+    _qpi_active = true;
+    return true;
+
+  case SFLASH_CMD_EXIT_QPI:
+  case SFLASH_CMD_EXIT_QPI_MX:
+    // Exit commands of other vendors are ignored
+    if (_dev->qpi_enter_command == SFLASH_CMD_ENTER_QPI
+            ? command == SFLASH_CMD_EXIT_QPI
+            : command == SFLASH_CMD_EXIT_QPI_MX) {
+      _qpi_active = false;
+      _read_params = 0;
+    }
+    return true;
+
+  default:
+    break;
+  }
+
+  _stats.errors++;
+  return false;
+}
+
+bool Adafruit_FlashTransport_Sim::readCommand(uint8_t command,
+                                              uint8_t *response,
+                                              uint32_t len) {
+  exitContinuousRead();
+
+  bus(_clock_rd, 0, 8 + len * 8, cmdLines());
+
+  uint8_t value;
+
+  // Nothing but the release command is accepted in deep power-down, output
+  // floats high
+  if (_qpi != _qpi_active || _power_down) {
+    command = 0; // garbage to the device
+  }
+
+  switch (command) {
+  case SFLASH_CMD_READ_STATUS:
+    _stats.status_reads++;
+    value = _sr1;
+    if (isBusy()) {
+      value |= SR_WIP | SR_WEL;
+    } else if (_wel) {
+      value |= SR_WEL;
+    }
+    memset(response, value, len);
+    return true;
+
+  case SFLASH_CMD_READ_STATUS2:
+    if (_dev->single_status_byte) {
+      break;
+    }
+    _stats.status_reads++;
+    memset(response, _suspended ? (_sr2 | SR2_SUS) : _sr2, len);
+    return true;
+
+  case SFLASH_CMD_READ_JEDEC_ID: {
+    if (isBusy()) {
+      break;
+    }
+
+    uint8_t ids[4] = {_dev->manufacturer_id, _dev->memory_type,
+                      _dev->capacity, 0};
+
+    // Fujitsu FRAM has continuation code in 2nd byte
+    if (_dev->is_fram) {
+      ids[1] = 0x7F;
+      ids[2] = _dev->memory_type;
+      ids[3] = _dev->capacity;
+    }
+
+    memset(response, 0, len);
+    memcpy(response, ids, min(len, (uint32_t)sizeof(ids)));
+    return true;
+  }
+
+  default:
+    break;
+  }
+
+  _stats.errors++;
+  memset(response, 0xff, len);
+  return false;
+}
+
+bool Adafruit_FlashTransport_Sim::writeCommand(uint8_t command,
+                                               uint8_t const *data,
+                                               uint32_t len) {
+  exitContinuousRead();
+
+  bus(_clock_wr, 0, 8 + len * 8, cmdLines());
+
+  if (isBusy() || _power_down || len == 0 || _qpi != _qpi_active) {
+    _stats.errors++;
+    return false;
+  }
+
+  uint64_t const tw_ns = (uint64_t)_timing.write_status_us * 1000;
+
+  switch (command) {
+  case SFLASH_CMD_WRITE_STATUS:
+    if (!startOperation(tw_ns)) {
+      break;
+    }
+
+    _sr1 = data[0] & ~(SR_WIP | SR_WEL);
+    if (len > 1 && !_dev->single_status_byte &&
+        !_dev->write_status_register_split) {
+      _sr2 = data[1];
+    }
+    return true;
+
+  case SFLASH_CMD_WRITE_STATUS2:
+    if (_dev->single_status_byte || !startOperation(tw_ns)) {
+      break;
+    }
+
+    _sr2 = data[0];
+    return true;
+
+  case SFLASH_CMD_SET_READ_PARAMS:
+    if (!_qpi_active || _dev->qpi_enter_command != SFLASH_CMD_ENTER_QPI) {
+      break;
+    }
+
+    _read_params = data[0];
+    return true;
+
+  default:
+    break;
+  }
+
+  _stats.errors++;
+  return false;
+}
+
+bool Adafruit_FlashTransport_Sim::eraseCommand(uint8_t command,
+                                               uint32_t addr) {
+  exitContinuousRead();
+
+  bus(_clock_wr, 0, 8 + 8 * _addr_len, cmdLines());
+
+  uint32_t unit;
+  uint32_t duration_us;
+
+  switch (command) {
+  case SFLASH_CMD_ERASE_PAGE:
+    unit = SFLASH_PAGE_SIZE;
+    duration_us = _timing.page_program_us;
+    break;
+
+  case SFLASH_CMD_ERASE_SECTOR:
+    unit = SFLASH_SECTOR_SIZE;
+    duration_us = _timing.sector_erase_us;
+    break;
+
+  case SFLASH_CMD_ERASE_BLOCK32:
+    unit = SFLASH_BLOCK32_SIZE;
+    duration_us = _timing.block32_erase_us;
+    break;
+
+  case SFLASH_CMD_ERASE_BLOCK:
+    unit = SFLASH_BLOCK_SIZE;
+    duration_us = _timing.block_erase_us;
+    break;
+
+  default:
+    unit = 0;
+    duration_us = 0;
+    break;
+  }
+
+  addr = maskAddress(addr, addressCommand(command));
+
+  if (addr != 0xFFFFFFFF) {
+    addr &= ~(unit - 1);
+  }
+
+  if (!unit || !_mem || _dev->is_fram || isBusy() || _power_down ||
+      addr == 0xFFFFFFFF || _qpi != _qpi_active ||
+      !startOperation((uint64_t)duration_us * 1000, addr, unit)) {
+    _stats.errors++;
+    return false;
+  }
+
+  memset(_mem + addr, 0xff, min(unit, _dev->total_size - addr));
+
+  if (command == SFLASH_CMD_ERASE_BLOCK) {
+    _stats.block_erases++;
+  } else if (command == SFLASH_CMD_ERASE_BLOCK32) {
+    _stats.block32_erases++;
+  } else {
+    _stats.sector_erases++;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Read & Write
+//--------------------------------------------------------------------+
+
+bool Adafruit_FlashTransport_Sim::readMemory(uint32_t addr, uint8_t *data,
+                                             uint32_t len) {
+  uint8_t dummy = 0;
+  uint8_t lines = 1;
+  bool quad_io = false;
+
+  if (_cmd_read == SFLASH_CMD_FAST_READ) {
+    dummy = 8;
+  } else if (_cmd_read == SFLASH_CMD_QUAD_READ) {
+    dummy = 8;
+    lines = 4;
+  } else if (_cmd_read == SFLASH_CMD_QUAD_IO_READ) {
+    lines = 4;
+    quad_io = true;
+  }
+
+  if (quad_io) {
+    // opcode is skipped in continuous read mode, address and 2 mode cycles on
+    // 4 lines then 4 dummy cycles
+    uint8_t const opcode = _cont_active ? 0 : (_qpi ? 2 : 8);
+    bus(_clock_rd, opcode + 2 * _addr_len + 2 + 4, len * 8, 4);
+    _cont_active = _cont_read && _dev->supports_continuous_read;
+  } else {
+    bus(_clock_rd, 8 + 8 * _addr_len + dummy, len * 8, lines);
+  }
+
+  addr = maskAddress(addr, addressCommand(_cmd_read));
+
+  // Only 0xEB is used in QPI mode. Winbond must be set to 4 dummy cycles, its
+  // default is 2.
+  bool const qpi_error =
+      (_qpi != _qpi_active) || (_qpi && !quad_io) ||
+      (_qpi && _dev->qpi_enter_command == SFLASH_CMD_ENTER_QPI &&
+       (_read_params & 0x30) != 0x10);
+
+  if (!_mem || isBusy() || _power_down || addr == 0xFFFFFFFF || qpi_error ||
+      (lines == 4 && !quadEnabled()) || (quad_io && !_dev->supports_quad_io)) {
+    _stats.errors++;
+    return false;
+  }
+
+  // contents of the suspended erase/program range are undefined
+  if (_suspended && addr < _op_addr + _op_len && _op_addr < addr + len) {
+    _stats.errors++;
+  }
+
+  // sequential read wraps around at the end of the device
+  while (len) {
+    uint32_t const count = min(len, _dev->total_size - addr);
+
+    memcpy(data, _mem + addr, count);
+    _stats.read_bytes += count;
+
+    data += count;
+    len -= count;
+    addr = 0;
+  }
+
+  return true;
+}
+
+bool Adafruit_FlashTransport_Sim::readMemoryV(FlashIoVec const *iov,
+                                              uint32_t count) {
+  bool rc = true;
+
+  // segments after the first share the transaction setup
+  for (uint32_t i = 0; i < count; i++) {
+    _same_transaction = (i > 0);
+    rc = readMemory(iov[i].addr, iov[i].buf, iov[i].len) && rc;
+  }
+
+  return rc;
+}
+
+bool Adafruit_FlashTransport_Sim::writeMemory(uint32_t addr,
+                                              uint8_t const *data,
+                                              uint32_t len) {
+  exitContinuousRead();
+
+  uint8_t const lines = _quad ? 4 : 1;
+
+  // QPI mode uses page program 0x02 with everything on 4 lines
+  if (_qpi) {
+    bus(_clock_wr, 0, 8 + 8 * _addr_len + len * 8, 4);
+  } else {
+    bus(_clock_wr, 8 + 8 * _addr_len, len * 8, lines);
+  }
+
+  uint8_t const command = (_quad && !_qpi) ? SFLASH_CMD_QUAD_PAGE_PROGRAM
+                                           : SFLASH_CMD_PAGE_PROGRAM;
+  addr = maskAddress(addr, addressCommand(command));
+
+  if (!_mem || isBusy() || _power_down || addr == 0xFFFFFFFF ||
+      _qpi != _qpi_active || (lines == 4 && !_dev->is_fram && !quadEnabled()) ||
+      !startOperation((uint64_t)_timing.page_program_us * 1000,
+                      addr & ~(SFLASH_PAGE_SIZE - 1), SFLASH_PAGE_SIZE)) {
+    _stats.errors++;
+    return false;
+  }
+
+  // FRAM: bytes are simply overwritten and there is no page boundary
+  if (_dev->is_fram) {
+    for (uint32_t i = 0; i < len; i++) {
+      _mem[(addr + i) % _dev->total_size] = data[i];
+    }
+    _stats.program_bytes += len;
+    return true;
+  }
+
+  // Only the last page size bytes are latched, address wraps within the page
+  // and programming can only clear bits.
+  uint32_t const page_addr = addr & ~(SFLASH_PAGE_SIZE - 1);
+  uint32_t const start = (len > SFLASH_PAGE_SIZE) ? len - SFLASH_PAGE_SIZE : 0;
+
+  for (uint32_t i = start; i < len; i++) {
+    _mem[page_addr + ((addr + i) & (SFLASH_PAGE_SIZE - 1))] &= data[i];
+  }
+
+  _stats.page_programs++;
+  _stats.program_bytes += len - start;
+
+  return true;
+}
+
+bool Adafruit_FlashTransport_Sim::writeMemoryWhenReady(uint32_t addr,
+                                                       uint8_t const *data,
+                                                       uint32_t len) {
+  exitContinuousRead();
+
+  // Status register is clocked out continuously in one transaction, device is
+  // seen ready on the first status byte after the program completes
+  bus(_clock_rd, 0, 16, cmdLines());
+  _stats.status_reads++;
+
+  if (isBusy() && !_suspended) {
+    uint64_t const byte_ns = (8000000000ULL / cmdLines()) / _clock_rd;
+    _now_ns += (_busy_until_ns - _now_ns + byte_ns - 1) / byte_ns * byte_ns;
+  }
+
+  // Write Enable and Page Program share the transaction setup
+  runCommand(SFLASH_CMD_WRITE_ENABLE);
+  _same_transaction = true;
+
+  return writeMemory(addr, data, len);
+}
+
+const uint8_t *Adafruit_FlashTransport_Sim::map(uint32_t addr, uint32_t len) {
+  if (!_mem || addr > _dev->total_size || len > _dev->total_size - addr) {
+    return NULL;
+  }
+
+  return _mem + addr;
+}
+
+//--------------------------------------------------------------------+
+// SFDP
+//--------------------------------------------------------------------+
+
+enum {
+  SFDP_BFPT_ADDR = 0x30,
+  SFDP_BFPT_DWORDS = 16,
+  SFDP_SIZE = SFDP_BFPT_ADDR + 4 * SFDP_BFPT_DWORDS
+};
+
+static void put_le32(uint8_t *buf, uint32_t value) {
+  buf[0] = (uint8_t)value;
+  buf[1] = (uint8_t)(value >> 8);
+  buf[2] = (uint8_t)(value >> 16);
+  buf[3] = (uint8_t)(value >> 24);
+}
+
+// SFDP header, one parameter header and the Basic Flash Parameter Table
+static void sfdp_table(SPIFlash_Device_t const *dev, uint8_t *table) {
+  memset(table, 0xff, SFDP_SIZE);
+
+  // SFDP signature, revision 1.6, 1 parameter header, access protocol
+  put_le32(table + 0, 0x50444653);
+  put_le32(table + 4, 0xFF000106);
+
+  // BFPT parameter header: id, revision 1.6, length and pointer
+  put_le32(table + 8, 0x00010600 | (SFDP_BFPT_DWORDS << 24));
+  put_le32(table + 12, 0xFF000000 | SFDP_BFPT_ADDR);
+
+  uint32_t dw[SFDP_BFPT_DWORDS];
+  memset(dw, 0, sizeof(dw));
+
+  bool const addr4 = dev->total_size > 16UL * 1024 * 1024;
+
+  // 1st: 4KB erase 0x20, page write granularity, 3 or 4 byte address, 1-1-4
+  dw[0] = 0x01 | 0x04 | (SFLASH_CMD_ERASE_SECTOR << 8);
+  if (addr4) {
+    dw[0] |= 1UL << 17;
+  }
+  if (dev->supports_qspi) {
+    dw[0] |= 1UL << 22;
+  }
+  if (dev->supports_quad_io) {
+    dw[0] |= 1UL << 21;
+  }
+
+  // 2nd: density in bits - 1
+  dw[1] = dev->total_size * 8 - 1;
+
+  // 3rd: 1-1-4 read 0x6B with 8 dummy cycles, 1-4-4 read 0xEB with 2 mode
+  // and 4 dummy cycles
+  if (dev->supports_qspi) {
+    dw[2] = ((uint32_t)SFLASH_CMD_QUAD_READ << 24) | (8UL << 16);
+  }
+  if (dev->supports_quad_io) {
+    dw[2] |= (SFLASH_CMD_QUAD_IO_READ << 8) | (2 << 5) | 4;
+  }
+
+  // 8th, 9th: erase type 1 is 4KB 0x20, type 2 is 64KB 0xD8, type 3 is 32KB
+  // 0x52
+  dw[7] = 12 | (SFLASH_CMD_ERASE_SECTOR << 8) | (16UL << 16) |
+          ((uint32_t)SFLASH_CMD_ERASE_BLOCK << 24);
+  dw[8] = 15 | (SFLASH_CMD_ERASE_BLOCK32 << 8);
+
+  // 11th: page size 256
+  dw[10] = 8UL << 4;
+
+  // 12th, 13th: suspend/resume opcodes, bit 31 set if not supported
+  if (dev->supports_suspend) {
+    dw[12] = ((uint32_t)SFLASH_CMD_SUSPEND << 24) |
+             ((uint32_t)SFLASH_CMD_RESUME << 16) | (SFLASH_CMD_SUSPEND << 8) |
+             SFLASH_CMD_RESUME;
+  } else {
+    dw[11] = 1UL << 31;
+  }
+
+  // 14th: deep power-down 0xB9/0xAB and exit delay (tRES1) in 1 us or 8 us
+  // units, bit 31 set if not supported
+  uint32_t const tres1 = dev->release_power_down_us;
+  if (tres1) {
+    dw[13] = ((uint32_t)SFLASH_CMD_POWER_DOWN << 23) |
+             ((uint32_t)SFLASH_CMD_RELEASE_POWER_DOWN << 15);
+    if (tres1 <= 32) {
+      dw[13] |= (1UL << 13) | ((tres1 - 1) << 8);
+    } else {
+      dw[13] |= (2UL << 13) | (((tres1 + 7) / 8 - 1) << 8);
+    }
+  } else {
+    dw[13] = 1UL << 31;
+  }
+
+  // 15th: quad enable requirement
+  uint32_t qer = 0;
+  if (dev->quad_enable_bit_mask == 0x40 && dev->single_status_byte) {
+    qer = 2; // bit 6 of status register 1
+  } else if (dev->quad_enable_bit_mask == 0x02) {
+    // bit 1 of status register 2, written with 0x31 or with 0x01 (2 bytes)
+    qer = dev->write_status_register_split ? 6 : 5;
+  }
+  dw[14] = qer << 20;
+
+  // 16th: enter 4-byte address mode with 0xB7
+  if (addr4) {
+    dw[15] = 1UL << 24;
+  }
+
+  for (uint8_t i = 0; i < SFDP_BFPT_DWORDS; i++) {
+    put_le32(table + SFDP_BFPT_ADDR + 4 * i, dw[i]);
+  }
+}
+
+bool Adafruit_FlashTransport_Sim::readSFDP(uint32_t addr, uint8_t *data,
+                                           uint32_t len) {
+  exitContinuousRead();
+
+  bus(_clock_rd, 8 + 24 + 8, len * 8, 1);
+
+  // FRAM has no SFDP and ignores the command, bus floats high
+  memset(data, 0xff, len);
+
+  // not read in QPI mode
+  if (isBusy() || _power_down || _qpi || _qpi_active) {
+    _stats.errors++;
+    return false;
+  }
+
+  if (_dev->is_fram) {
+    return true;
+  }
+
+  uint8_t table[SFDP_SIZE];
+  sfdp_table(_dev, table);
+
+  for (uint32_t i = 0; i < len && addr + i < SFDP_SIZE; i++) {
+    data[i] = table[addr + i];
+  }
+
+  return true;
+}
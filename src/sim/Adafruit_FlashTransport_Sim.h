@@ -0,0 +1,178 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ADAFRUIT_FLASHTRANSPORT_SIM_H_
+#define ADAFRUIT_FLASHTRANSPORT_SIM_H_
+
+#include "Arduino.h"
+#include "flash_devices.h"
+
+// Latencies used by the simulated device. Values are typical datasheet
+// numbers, not worst case.
+typedef struct {
+  uint32_t page_program_us;      // tPP
+  uint32_t sector_erase_us;      // tSE (4 KB)
+  uint32_t block32_erase_us;     // tBE1 (32 KB)
+  uint32_t block_erase_us;       // tBE (64 KB)
+  uint32_t chip_erase_ms_per_mb; // tCE, scaled with device size
+  uint32_t write_status_us;      // tW
+  uint32_t suspend_us;           // tSUS, suspend latency
+
+  // CS setup/hold and software overhead added to every command
+  uint32_t transaction_ns;
+} SPIFlash_SimTiming_t;
+
+// Counters of operations executed by the simulated device
+typedef struct {
+  uint32_t commands;
+  uint32_t status_reads;
+  uint32_t read_bytes;
+  uint32_t page_programs;
+  uint32_t program_bytes;
+  uint32_t sector_erases;
+  uint32_t block32_erases;
+  uint32_t block_erases;
+  uint32_t chip_erases;
+  uint32_t suspends;
+  uint32_t power_downs;
+
+  // commands ignored e.g device is busy, WEL is not set or address is invalid
+  uint32_t errors;
+} SPIFlash_SimStats_t;
+
+// Simulated NOR flash device backed by a RAM buffer (or a mmap'd image file on
+// Linux). It enforces NOR rules (program can only clear bits, erase works on
+// whole units, page program wraps at page boundary) and keeps a virtual clock
+// that models SPI clock cost and tPP/tSE/tBE/tCE so that throughput can be
+// benchmarked without real hardware. Time only advances with bus traffic (e.g
+// status polling) or advanceTime(), which makes results deterministic.
+class Adafruit_FlashTransport_Sim : public Adafruit_FlashTransport {
+public:
+  // buffer must be at least device->total_size bytes. If NULL, it is allocated
+  // in begin() and filled with 0xFF (erased state).
+  Adafruit_FlashTransport_Sim(SPIFlash_Device_t const *device,
+                              uint8_t *buffer = NULL, bool quad = true);
+
+  ~Adafruit_FlashTransport_Sim();
+
+#if defined(__linux__)
+  // Back the flash contents by an image file (created and erased if it does
+  // not exist) instead of RAM. Must be called before begin().
+  void setImageFile(const char *image_path) { _image_path = image_path; }
+#endif
+
+  virtual void begin(void);
+  virtual void end(void);
+
+  virtual bool supportQuadMode(void) { return _quad; }
+  virtual bool support4ByteOpcodes(void) { return true; }
+  virtual bool supportQpiMode(void) { return _quad; }
+  virtual bool supportPipelinedWrite(void) { return true; }
+  virtual bool supportPowerDown(void) { return true; }
+
+  virtual void setClockSpeed(uint32_t write_hz, uint32_t read_hz);
+
+  virtual bool runCommand(uint8_t command);
+  virtual bool readCommand(uint8_t command, uint8_t *response, uint32_t len);
+  virtual bool writeCommand(uint8_t command, uint8_t const *data, uint32_t len);
+  virtual bool eraseCommand(uint8_t command, uint32_t addr);
+
+  virtual bool readMemory(uint32_t addr, uint8_t *data, uint32_t len);
+  virtual bool readMemoryV(FlashIoVec const *iov, uint32_t count);
+  virtual bool writeMemory(uint32_t addr, uint8_t const *data, uint32_t len);
+  virtual bool writeMemoryWhenReady(uint32_t addr, uint8_t const *data,
+                                    uint32_t len);
+
+  // SFDP tables (JESD216B) generated from the device descriptor
+  virtual bool readSFDP(uint32_t addr, uint8_t *data, uint32_t len);
+
+  // Contents are in RAM, mapped reads bypass the bus and timing model
+  virtual const uint8_t *map(uint32_t addr, uint32_t len);
+
+  //------------- Simulation control -------------//
+  void setTiming(SPIFlash_SimTiming_t const *timing) { _timing = *timing; }
+  SPIFlash_SimTiming_t const *getTiming(void) { return &_timing; }
+
+  // Virtual time elapsed since construction in nanoseconds
+  uint64_t timeNs(void) { return _now_ns; }
+
+  // Let time pass e.g to model CPU work or idle between operations
+  void advanceTime(uint32_t us) { _now_ns += (uint64_t)us * 1000; }
+
+  SPIFlash_SimStats_t const *getStats(void) { return &_stats; }
+  void resetStats(void);
+
+  // Direct access to the contents, bypassing the bus and timing model
+  uint8_t *data(void) { return _mem; }
+
+private:
+  SPIFlash_Device_t const *_dev;
+  uint8_t *_mem;
+  bool _mem_owned;
+  bool _quad;
+
+#if defined(__linux__)
+  const char *_image_path;
+  int _fd;
+#endif
+
+  uint8_t _sr1, _sr2; // status registers without WIP and WEL
+  bool _wel;
+  bool _reset_enabled;
+  bool _addr4; // 4-byte address mode
+
+  uint32_t _clock_wr, _clock_rd;
+  uint64_t _now_ns;
+  uint64_t _busy_until_ns;
+  bool _same_transaction; // next command is sent without transaction setup
+
+  // Erase/program in progress, len = 0 if it cannot be suspended
+  uint32_t _op_addr, _op_len;
+  bool _suspended;
+  uint64_t _suspended_ns; // remaining duration of suspended operation
+
+  bool _cont_active; // continuous read mode of 0xEB, opcode is skipped
+
+  // Device is in QPI mode, it ignores commands sent on 1 line and vice versa
+  bool _qpi_active;
+  uint8_t _read_params; // Winbond QPI read parameters (dummy cycles)
+
+  bool _power_down; // in deep power-down, only 0xAB is accepted
+
+  SPIFlash_SimTiming_t _timing;
+  SPIFlash_SimStats_t _stats;
+
+  bool isBusy(void) { return _now_ns < _busy_until_ns; }
+  uint8_t cmdLines(void) { return _qpi ? 4 : 1; }
+  bool quadEnabled(void);
+  uint32_t maskAddress(uint32_t addr, uint8_t command);
+  void exitContinuousRead(void);
+
+  void bus(uint32_t clock_hz, uint32_t single_bits, uint32_t data_bits,
+           uint8_t data_lines);
+  bool startOperation(uint64_t duration_ns, uint32_t addr = 0,
+                      uint32_t len = 0);
+};
+
+#endif /* ADAFRUIT_FLASHTRANSPORT_SIM_H_ */
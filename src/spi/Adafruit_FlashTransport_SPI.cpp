@@ -24,10 +24,18 @@
 
 #include "Adafruit_FlashTransport.h"
 
+// writeMemoryWhenReady(): status bytes clocked out per transaction, the bus is
+// released and yield() called in between. Page program takes up to a few ms,
+// a device stuck busy (e.g in deep power-down) fails the write instead.
+#define WIP_POLL_BYTES 64
+#define WIP_TIMEOUT_MS 50
+
 Adafruit_FlashTransport_SPI::Adafruit_FlashTransport_SPI(
     uint8_t ss, SPIClass *spiinterface) {
   _cmd_read = SFLASH_CMD_READ;
   _addr_len = 3; // work with most device if not set
+  _cont_read = false;
+  _qpi = false;
   _ss = ss;
   _spi = spiinterface;
   _clock_wr = _clock_rd = 4000000;
@@ -98,7 +106,7 @@ bool Adafruit_FlashTransport_SPI::writeCommand(uint8_t command,
 bool Adafruit_FlashTransport_SPI::eraseCommand(uint8_t command, uint32_t addr) {
   beginTransaction(_clock_wr);
 
-  uint8_t cmd_with_addr[5] = {command};
+  uint8_t cmd_with_addr[5] = {addressCommand(command)};
   fillAddress(cmd_with_addr + 1, addr);
 
   _spi->transfer(cmd_with_addr, 1 + _addr_len);
@@ -130,8 +138,34 @@ void Adafruit_FlashTransport_SPI::fillAddress(uint8_t *buf, uint32_t addr) {
 bool Adafruit_FlashTransport_SPI::readMemory(uint32_t addr, uint8_t *data,
                                              uint32_t len) {
   beginTransaction(_clock_rd);
+  readData(addr, data, len);
+  endTransaction();
+
+  return true;
+}
+
+bool Adafruit_FlashTransport_SPI::readMemoryV(FlashIoVec const *iov,
+                                              uint32_t count) {
+  // Segments share the transaction settings, CS is toggled between them
+  beginTransaction(_clock_rd);
 
-  uint8_t cmd_with_addr[6] = {_cmd_read};
+  for (uint32_t i = 0; i < count; i++) {
+    if (i) {
+      digitalWrite(_ss, HIGH);
+      digitalWrite(_ss, LOW);
+    }
+    readData(iov[i].addr, iov[i].buf, iov[i].len);
+  }
+
+  endTransaction();
+
+  return true;
+}
+
+// Read command, address and data. CS must already be asserted.
+void Adafruit_FlashTransport_SPI::readData(uint32_t addr, uint8_t *data,
+                                           uint32_t len) {
+  uint8_t cmd_with_addr[6] = {addressCommand(_cmd_read)};
   fillAddress(cmd_with_addr + 1, addr);
 
   // Fast Read has 1 extra dummy byte
@@ -148,18 +182,60 @@ bool Adafruit_FlashTransport_SPI::readMemory(uint32_t addr, uint8_t *data,
 #else
   _spi->transfer(data, len);
 #endif
+}
+
+bool Adafruit_FlashTransport_SPI::writeMemory(uint32_t addr,
+                                              uint8_t const *data,
+                                              uint32_t len) {
+  beginTransaction(_clock_wr);
+  pageProgram(addr, data, len);
+  endTransaction();
+
+  return true;
+}
 
+bool Adafruit_FlashTransport_SPI::writeMemoryWhenReady(uint32_t addr,
+                                                       uint8_t const *data,
+                                                       uint32_t len) {
+  // Status register is clocked out continuously while CS is low, poll WIP
+  // with a few transactions instead of one per status read
+  uint32_t const start_ms = millis();
+  bool busy;
+
+  while (true) {
+    beginTransaction(_clock_rd);
+    _spi->transfer(SFLASH_CMD_READ_STATUS);
+    uint32_t count = WIP_POLL_BYTES;
+    while ((busy = _spi->transfer(0xFF) & 0x01) && --count) {
+    }
+    endTransaction();
+
+    if (!busy) {
+      break;
+    }
+
+    if (millis() - start_ms >= WIP_TIMEOUT_MS) {
+      return false;
+    }
+    yield();
+  }
+
+  // Write Enable and Page Program share the transaction settings
+  beginTransaction(_clock_wr);
+  _spi->transfer(SFLASH_CMD_WRITE_ENABLE);
+  digitalWrite(_ss, HIGH);
+  digitalWrite(_ss, LOW);
+  pageProgram(addr, data, len);
   endTransaction();
 
   return true;
 }
 
-bool Adafruit_FlashTransport_SPI::writeMemory(uint32_t addr,
+// Page Program command, address and data. CS must already be asserted.
+void Adafruit_FlashTransport_SPI::pageProgram(uint32_t addr,
                                               uint8_t const *data,
                                               uint32_t len) {
-  beginTransaction(_clock_wr);
-
-  uint8_t cmd_with_addr[5] = {SFLASH_CMD_PAGE_PROGRAM};
+  uint8_t cmd_with_addr[5] = {addressCommand(SFLASH_CMD_PAGE_PROGRAM)};
   fillAddress(cmd_with_addr + 1, addr);
 
   _spi->transfer(cmd_with_addr, 1 + _addr_len);
@@ -174,6 +250,20 @@ bool Adafruit_FlashTransport_SPI::writeMemory(uint32_t addr,
     _spi->transfer(*data++);
   }
 #endif
+}
+
+bool Adafruit_FlashTransport_SPI::readSFDP(uint32_t addr, uint8_t *data,
+                                           uint32_t len) {
+  beginTransaction(_clock_rd);
+
+  // SFDP always uses 3 address bytes followed by 1 dummy byte
+  uint8_t cmd_with_addr[5] = {SFLASH_CMD_READ_SFDP, (uint8_t)(addr >> 16),
+                              (uint8_t)(addr >> 8), (uint8_t)addr, 0xFF};
+  _spi->transfer(cmd_with_addr, sizeof(cmd_with_addr));
+
+  while (len--) {
+    *data++ = _spi->transfer(0xFF);
+  }
 
   endTransaction();
 
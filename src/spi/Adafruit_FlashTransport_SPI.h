@@ -45,6 +45,9 @@ public:
   virtual void end(void);
 
   virtual bool supportQuadMode(void) { return false; }
+  virtual bool support4ByteOpcodes(void) { return true; }
+  virtual bool supportPipelinedWrite(void) { return true; }
+  virtual bool supportPowerDown(void) { return true; }
 
   virtual void setClockSpeed(uint32_t write_hz, uint32_t read_hz);
 
@@ -54,10 +57,17 @@ public:
   virtual bool eraseCommand(uint8_t command, uint32_t addr);
 
   virtual bool readMemory(uint32_t addr, uint8_t *data, uint32_t len);
+  virtual bool readMemoryV(FlashIoVec const *iov, uint32_t count);
   virtual bool writeMemory(uint32_t addr, uint8_t const *data, uint32_t len);
+  virtual bool writeMemoryWhenReady(uint32_t addr, uint8_t const *data,
+                                    uint32_t len);
+
+  virtual bool readSFDP(uint32_t addr, uint8_t *data, uint32_t len);
 
 private:
   void fillAddress(uint8_t *buf, uint32_t addr);
+  void readData(uint32_t addr, uint8_t *data, uint32_t len);
+  void pageProgram(uint32_t addr, uint8_t const *data, uint32_t len);
 
   void beginTransaction(uint32_t clock_hz) {
     _spi->beginTransaction(SPISettings(clock_hz, MSBFIRST, SPI_MODE0));
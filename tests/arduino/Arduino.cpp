@@ -0,0 +1,70 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Arduino.h"
+#include "SPI.h"
+
+#include <time.h>
+
+HostSerial Serial;
+SPIClass SPI;
+
+static uint64_t host_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void pinMode(int pin, int mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(int pin, int val) {
+  (void)pin;
+  (void)val;
+}
+
+uint32_t millis(void) { return (uint32_t)(host_us() / 1000); }
+
+uint32_t micros(void) { return (uint32_t)host_us(); }
+
+void delay(uint32_t ms) { delayMicroseconds(ms * 1000); }
+
+void delayMicroseconds(uint32_t us) {
+  uint64_t const start = host_us();
+  while (host_us() - start < us) {
+  }
+}
+
+void yield(void) {}
+
+void HostSerial::print(unsigned long val, int base) {
+  printf(base == HEX ? "%lX" : "%lu", val);
+}
+
+void HostSerial::print(long val, int base) {
+  printf(base == HEX ? "%lX" : "%ld", val);
+}
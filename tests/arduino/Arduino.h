@@ -0,0 +1,94 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Minimal Arduino API to build the library on a workstation, together with
+// the simulated flash transport. Time comes from the host clock.
+
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+
+#define DEC 10
+#define HEX 16
+
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef max
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+// Prints to stdout
+class HostSerial {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  operator bool() { return true; }
+  void flush(void) { fflush(stdout); }
+
+  void print(const char *str) { fputs(str, stdout); }
+  void print(char c) { putchar(c); }
+  void print(unsigned long val, int base = DEC);
+  void print(long val, int base = DEC);
+  void print(unsigned int val, int base = DEC) {
+    print((unsigned long)val, base);
+  }
+  void print(int val, int base = DEC) { print((long)val, base); }
+  void print(double val, int digits = 2) { printf("%.*f", digits, val); }
+
+  void println(void) { putchar('\n'); }
+  template <class T> void println(T val) {
+    print(val);
+    println();
+  }
+  template <class T> void println(T val, int base) {
+    print(val, base);
+    println();
+  }
+};
+
+extern HostSerial Serial;
+
+#endif /* ARDUINO_H_ */
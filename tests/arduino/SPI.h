@@ -0,0 +1,59 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef SPI_H_
+#define SPI_H_
+
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+// No SPI bus on the host: compiles the SPI transport, reads back all ones
+class SPISettings {
+public:
+  SPISettings(uint32_t clock, uint8_t order, uint8_t mode) {
+    (void)clock;
+    (void)order;
+    (void)mode;
+  }
+};
+
+class SPIClass {
+public:
+  void begin(void) {}
+  void end(void) {}
+  void beginTransaction(SPISettings settings) { (void)settings; }
+  void endTransaction(void) {}
+  uint8_t transfer(uint8_t data) {
+    (void)data;
+    return 0xFF;
+  }
+  void transfer(void *buf, size_t count) { memset(buf, 0xFF, count); }
+};
+
+extern SPIClass SPI;
+
+#endif /* SPI_H_ */
@@ -0,0 +1,51 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef SDFAT_ADAFRUIT_FORK_H_
+#define SDFAT_ADAFRUIT_FORK_H_
+
+// Block device interface of SdFat v2, the only part used by the library
+
+#include "Arduino.h"
+
+#define SD_FAT_VERSION 20000
+#define USE_BLOCK_DEVICE_INTERFACE 1
+#define FAT12_SUPPORT 1
+
+class FsBlockDeviceInterface {
+public:
+  virtual ~FsBlockDeviceInterface() {}
+
+  virtual bool isBusy() = 0;
+  virtual bool readSector(uint32_t sector, uint8_t *dst) = 0;
+  virtual bool readSectors(uint32_t sector, uint8_t *dst, size_t ns) = 0;
+  virtual uint32_t sectorCount() = 0;
+  virtual bool syncDevice() = 0;
+  virtual bool writeSector(uint32_t sector, const uint8_t *src) = 0;
+  virtual bool writeSectors(uint32_t sector, const uint8_t *src,
+                            size_t ns) = 0;
+};
+
+#endif /* SDFAT_ADAFRUIT_FORK_H_ */
@@ -0,0 +1,139 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Sector cache of Adafruit_SPIFlash and Adafruit_FlashCache: coherence with
+// flash, program-only sync, LRU lines and whole-sector writes
+
+#include "test_common.h"
+
+static uint8_t blk[512];
+static uint8_t out[SFLASH_SECTOR_SIZE];
+static uint8_t sector[SFLASH_SECTOR_SIZE];
+
+static void fill(uint8_t *data, uint32_t len, uint32_t seed) {
+  for (uint32_t i = 0; i < len; i++) {
+    data[i] = (uint8_t)(i * 13 + seed);
+  }
+}
+
+int main(void) {
+  Adafruit_FlashTransport_Sim sim(&test_device);
+  Adafruit_SPIFlash flash(&sim, true, 2);
+
+  CHECK(flash.begin());
+  CHECK(flash.isCached());
+  CHECK(flash.sectorCount() == test_device.total_size / 512);
+
+  uint8_t *mem = sim.data();
+  CHECK(flash.eraseChip());
+  flash.waitUntilReady();
+
+  // Written blocks are read back from the cache, flash is updated on sync
+  fill(blk, sizeof(blk), 1);
+  CHECK(flash.writeSector(3, blk));
+  CHECK(flash.readSector(3, out));
+  CHECK(memcmp(out, blk, sizeof(blk)) == 0);
+  CHECK(mem[3 * 512] == 0xFF);
+
+  // Appending to erased space only programs pages
+  sim.resetStats();
+  CHECK(flash.syncDevice());
+  CHECK(memcmp(mem + 3 * 512, blk, sizeof(blk)) == 0);
+  CHECK(sim.getStats()->sector_erases == 0);
+  CHECK(sim.getStats()->page_programs == 2);
+
+  // Setting bits back to 1 needs an erase, other blocks of the sector are kept
+  fill(blk, sizeof(blk), 2);
+  CHECK(flash.writeSector(4, blk));
+  CHECK(flash.syncDevice());
+  blk[0] = 0xFF;
+  CHECK(flash.writeSector(3, blk));
+  sim.resetStats();
+  CHECK(flash.syncDevice());
+  CHECK(sim.getStats()->sector_erases == 1);
+  CHECK(memcmp(mem + 3 * 512, blk, sizeof(blk)) == 0);
+  fill(blk, sizeof(blk), 2);
+  CHECK(memcmp(mem + 4 * 512, blk, sizeof(blk)) == 0);
+
+  // Alternating between two sectors stays in the two lines
+  sim.resetStats();
+  for (uint32_t i = 0; i < 8; i++) {
+    fill(blk, sizeof(blk), 10 + i);
+    CHECK(flash.writeSector(16 + (i & 1) * 8 + i / 2, blk));
+  }
+  CHECK(sim.getStats()->page_programs == 0);
+  CHECK(sim.getStats()->sector_erases == 0);
+  CHECK(flash.syncDevice());
+  for (uint32_t i = 0; i < 8; i++) {
+    fill(blk, sizeof(blk), 10 + i);
+    CHECK(memcmp(mem + (16 + (i & 1) * 8 + i / 2) * 512, blk, sizeof(blk)) ==
+          0);
+  }
+
+  // Raw writes through Adafruit_SPIFlash flush overlapping cached sectors
+  fill(blk, sizeof(blk), 30);
+  CHECK(flash.writeSector(40, blk));
+  CHECK(flash.eraseSector(40 * 512 / SFLASH_SECTOR_SIZE));
+  flash.waitUntilReady();
+  CHECK(flash.readSector(40, out));
+  CHECK(out[0] == 0xFF && out[511] == 0xFF);
+
+  // Whole sectors bypass the cache
+  fill(sector, sizeof(sector), 40);
+  sim.resetStats();
+  CHECK(flash.writeSectors(8 * 8, sector, 8));
+  flash.waitUntilReady();
+  CHECK(memcmp(mem + 8 * SFLASH_SECTOR_SIZE, sector, sizeof(sector)) == 0);
+  CHECK(sim.getStats()->sector_erases == 1);
+  CHECK(flash.readSectors(8 * 8, out, 8));
+  CHECK(memcmp(out, sector, sizeof(sector)) == 0);
+
+  // ... and report failed erases and programs
+  FailingSim failing;
+  Adafruit_SPIFlash flash2(&failing, true, 2);
+  CHECK(flash2.begin());
+
+  failing.fail_erase = true;
+  CHECK(!flash2.writeSectors(0, sector, 8));
+  failing.fail_erase = false;
+  CHECK(flash2.eraseSector(0));
+  flash2.waitUntilReady();
+
+  failing.fail_program = true;
+  CHECK(!flash2.writeSectors(0, sector, 8));
+  failing.fail_program = false;
+  CHECK(flash2.writeSectors(0, sector, 8));
+  flash2.waitUntilReady();
+  CHECK(memcmp(failing.data(), sector, sizeof(sector)) == 0);
+
+  // Without lines writes fail, reads come from flash
+  Adafruit_FlashCache none(0);
+  CHECK(none.lineCount() == 0);
+  CHECK(!none.write(&flash, 0, blk, sizeof(blk)));
+  CHECK(none.sync(&flash));
+  CHECK(none.read(&flash, 8 * SFLASH_SECTOR_SIZE, out, sizeof(out)));
+  CHECK(memcmp(out, sector, sizeof(sector)) == 0);
+
+  return TEST_RESULT();
+}
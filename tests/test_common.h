@@ -0,0 +1,86 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef TEST_COMMON_H_
+#define TEST_COMMON_H_
+
+// Checks of the host tests, a failed check is reported and the test goes on.
+// main() returns TEST_RESULT().
+
+#include "Adafruit_SPIFlash.h"
+
+static int test_failures = 0;
+
+#define CHECK(_cond)                                                           \
+  do {                                                                         \
+    if (!(_cond)) {                                                            \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #_cond);         \
+      test_failures++;                                                         \
+    }                                                                          \
+  } while (0)
+
+#define TEST_RESULT() (test_failures ? 1 : 0)
+
+// 2 MB device with 4K sectors, 64K blocks and Quad I/O
+static const SPIFlash_Device_t test_device = W25Q16JV_IQ;
+
+// Simulated transport whose program and erase commands can be made to fail,
+// as if the transfer did not go through. Write Enable is cleared like a
+// device that did not receive the command would not keep it.
+class FailingSim : public Adafruit_FlashTransport_Sim {
+public:
+  bool fail_program;
+  bool fail_erase;
+
+  FailingSim()
+      : Adafruit_FlashTransport_Sim(&test_device), fail_program(false),
+        fail_erase(false) {}
+
+  virtual bool writeMemory(uint32_t addr, uint8_t const *data, uint32_t len) {
+    if (fail_program) {
+      runCommand(SFLASH_CMD_WRITE_DISABLE);
+      return false;
+    }
+    return Adafruit_FlashTransport_Sim::writeMemory(addr, data, len);
+  }
+
+  virtual bool writeMemoryWhenReady(uint32_t addr, uint8_t const *data,
+                                    uint32_t len) {
+    if (fail_program) {
+      return false;
+    }
+    return Adafruit_FlashTransport_Sim::writeMemoryWhenReady(addr, data, len);
+  }
+
+  virtual bool eraseCommand(uint8_t command, uint32_t addr) {
+    if (fail_erase) {
+      runCommand(SFLASH_CMD_WRITE_DISABLE);
+      return false;
+    }
+    return Adafruit_FlashTransport_Sim::eraseCommand(command, addr);
+  }
+};
+
+#endif /* TEST_COMMON_H_ */
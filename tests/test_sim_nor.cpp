@@ -0,0 +1,126 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// NOR flash rules enforced by the simulated device, driven directly through
+// the transport commands
+
+#include "test_common.h"
+
+static uint8_t status(Adafruit_FlashTransport_Sim &sim) {
+  uint8_t sr;
+  sim.readCommand(SFLASH_CMD_READ_STATUS, &sr, 1);
+  return sr;
+}
+
+// Let the erase or program in progress complete
+static void wait_idle(Adafruit_FlashTransport_Sim &sim) {
+  while (status(sim) & 0x01) {
+    sim.advanceTime(100);
+  }
+}
+
+static bool program(Adafruit_FlashTransport_Sim &sim, uint32_t addr,
+                    uint8_t const *data, uint32_t len) {
+  sim.runCommand(SFLASH_CMD_WRITE_ENABLE);
+  bool const ret = sim.writeMemory(addr, data, len);
+  wait_idle(sim);
+  return ret;
+}
+
+int main(void) {
+  // single line I/O, the Quad Enable bit is not set without the library
+  Adafruit_FlashTransport_Sim sim(&test_device, NULL, false);
+  sim.begin();
+
+  uint8_t *mem = sim.data();
+  CHECK(mem[0] == 0xFF && mem[test_device.total_size - 1] == 0xFF);
+
+  // JEDEC ID of the simulated device
+  uint8_t id[3];
+  sim.readCommand(SFLASH_CMD_READ_JEDEC_ID, id, 3);
+  CHECK(id[0] == test_device.manufacturer_id &&
+        id[1] == test_device.memory_type && id[2] == test_device.capacity);
+
+  // Program without Write Enable is ignored
+  uint8_t data[16];
+  memset(data, 0x0F, sizeof(data));
+  CHECK(!sim.writeMemory(0, data, sizeof(data)));
+  CHECK(mem[0] == 0xFF);
+  CHECK(sim.getStats()->errors == 1);
+
+  // Program can only clear bits
+  CHECK(program(sim, 0, data, sizeof(data)));
+  CHECK(mem[0] == 0x0F && mem[15] == 0x0F && mem[16] == 0xFF);
+  memset(data, 0xF3, sizeof(data));
+  CHECK(program(sim, 0, data, sizeof(data)));
+  CHECK(mem[0] == 0x03 && mem[15] == 0x03);
+
+  // Write Enable is cleared by the program
+  CHECK((status(sim) & 0x02) == 0);
+
+  // Address wraps within the page
+  memset(data, 0x55, sizeof(data));
+  CHECK(program(sim, 2 * SFLASH_PAGE_SIZE - 6, data, sizeof(data)));
+  CHECK(mem[2 * SFLASH_PAGE_SIZE - 1] == 0x55);
+  CHECK(mem[2 * SFLASH_PAGE_SIZE] == 0xFF);
+  CHECK(mem[SFLASH_PAGE_SIZE] == 0x55 && mem[SFLASH_PAGE_SIZE + 9] == 0x55);
+  CHECK(mem[SFLASH_PAGE_SIZE + 10] == 0xFF);
+
+  // Device is busy while the program is in progress, commands are ignored
+  uint32_t const errors = sim.getStats()->errors;
+  sim.runCommand(SFLASH_CMD_WRITE_ENABLE);
+  CHECK(sim.writeMemory(8192, data, sizeof(data)));
+  CHECK(status(sim) & 0x01);
+  CHECK(!sim.writeMemory(8192 + 16, data, sizeof(data)));
+  CHECK(sim.getStats()->errors == errors + 1);
+  wait_idle(sim);
+
+  // Sector erase resets exactly one 4K sector, after tSE
+  memset(mem + 4096, 0, 3 * 4096);
+  sim.runCommand(SFLASH_CMD_WRITE_ENABLE);
+  CHECK(sim.eraseCommand(SFLASH_CMD_ERASE_SECTOR, 8192 + 100));
+  uint64_t const start_ns = sim.timeNs();
+  wait_idle(sim);
+  CHECK(sim.timeNs() - start_ns >= sim.getTiming()->sector_erase_us * 1000ULL);
+  CHECK(mem[4096 + 4095] == 0x00);
+  CHECK(mem[8192] == 0xFF && mem[8192 + 4095] == 0xFF);
+  CHECK(mem[12288] == 0x00);
+
+  // Block erase resets the 64K block
+  sim.runCommand(SFLASH_CMD_WRITE_ENABLE);
+  CHECK(sim.eraseCommand(SFLASH_CMD_ERASE_BLOCK, 0));
+  wait_idle(sim);
+  CHECK(mem[0] == 0xFF && mem[4096] == 0xFF && mem[12288] == 0xFF);
+  CHECK(sim.getStats()->sector_erases == 1 &&
+        sim.getStats()->block_erases == 1);
+
+  // Erase without Write Enable is ignored
+  mem[0] = 0;
+  CHECK(!sim.eraseCommand(SFLASH_CMD_ERASE_SECTOR, 0));
+  CHECK(mem[0] == 0);
+
+  sim.end();
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,155 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Raw flash access of Adafruit_SPIFlashBase: writeBuffer() across pages,
+// skipBlank, pipelining, eraseRange() and the non-blocking write
+
+#include "test_common.h"
+
+static uint8_t buf[3 * SFLASH_SECTOR_SIZE];
+static uint8_t out[sizeof(buf)];
+
+static void fill(uint8_t *data, uint32_t len, uint32_t seed) {
+  for (uint32_t i = 0; i < len; i++) {
+    data[i] = (uint8_t)((i * 7 + seed) ^ (i >> 8));
+  }
+}
+
+int main(void) {
+  Adafruit_FlashTransport_Sim sim(&test_device);
+  Adafruit_SPIFlashBase flash(&sim);
+
+  CHECK(flash.begin());
+  CHECK(flash.size() == test_device.total_size);
+  CHECK(flash.getJEDECID() == 0xEF4015);
+
+  uint8_t *mem = sim.data();
+
+  // Unaligned write spanning several pages
+  CHECK(flash.eraseSector(0));
+  fill(buf, 1000, 1);
+  CHECK(flash.writeBuffer(0x1F0, buf, 1000) == 1000);
+  CHECK(flash.readBuffer(0x1F0, out, 1000) == 1000);
+  CHECK(memcmp(out, buf, 1000) == 0);
+  flash.waitUntilReady();
+  CHECK(memcmp(mem + 0x1F0, buf, 1000) == 0);
+  CHECK(mem[0x1EF] == 0xFF && mem[0x1F0 + 1000] == 0xFF);
+
+  // Same contents and page programs with and without pipelining, fewer status
+  // reads with it
+  uint32_t status_reads[2];
+  for (uint8_t pipelined = 0; pipelined < 2; pipelined++) {
+    flash.setWritePipelining(pipelined);
+    CHECK(flash.eraseBlock(1));
+    flash.waitUntilReady();
+    sim.resetStats();
+
+    fill(buf, sizeof(buf), pipelined);
+    CHECK(flash.writeBuffer(SFLASH_BLOCK_SIZE, buf, sizeof(buf)) ==
+          sizeof(buf));
+    flash.waitUntilReady();
+
+    CHECK(memcmp(mem + SFLASH_BLOCK_SIZE, buf, sizeof(buf)) == 0);
+    CHECK(sim.getStats()->page_programs == sizeof(buf) / SFLASH_PAGE_SIZE);
+    CHECK(sim.getStats()->errors == 0);
+    status_reads[pipelined] = sim.getStats()->status_reads;
+  }
+  CHECK(status_reads[1] < status_reads[0]);
+
+  // skipBlank does not program the all 0xFF pages
+  CHECK(flash.eraseSector(2));
+  memset(buf, 0xFF, SFLASH_SECTOR_SIZE);
+  buf[5 * SFLASH_PAGE_SIZE] = 0x12;
+  sim.resetStats();
+  CHECK(flash.writeBuffer(2 * SFLASH_SECTOR_SIZE, buf, SFLASH_SECTOR_SIZE,
+                          true) == SFLASH_SECTOR_SIZE);
+  flash.waitUntilReady();
+  CHECK(sim.getStats()->page_programs == 1);
+  CHECK(mem[2 * SFLASH_SECTOR_SIZE + 5 * SFLASH_PAGE_SIZE] == 0x12);
+
+  // eraseRange() uses the largest units that fit
+  memset(mem, 0, 4 * SFLASH_BLOCK_SIZE);
+  sim.resetStats();
+  CHECK(flash.eraseRange(SFLASH_BLOCK_SIZE - SFLASH_SECTOR_SIZE,
+                         SFLASH_BLOCK_SIZE + 2 * SFLASH_SECTOR_SIZE));
+  flash.waitUntilReady();
+  CHECK(sim.getStats()->block_erases == 1 &&
+        sim.getStats()->sector_erases == 2);
+  CHECK(flash.isErased(SFLASH_BLOCK_SIZE - SFLASH_SECTOR_SIZE,
+                       SFLASH_BLOCK_SIZE + 2 * SFLASH_SECTOR_SIZE));
+  CHECK(mem[SFLASH_BLOCK_SIZE - SFLASH_SECTOR_SIZE - 1] == 0);
+  CHECK(mem[2 * SFLASH_BLOCK_SIZE + SFLASH_SECTOR_SIZE] == 0);
+
+  // Ranges past the end are rejected, including ones wrapping in 32 bits
+  CHECK(!flash.eraseRange(0x1000, 0xFFFFF000UL));
+  CHECK(!flash.eraseRange(flash.size(), SFLASH_SECTOR_SIZE));
+  CHECK(flash.map(0x1000, 0xFFFFF000UL) == NULL);
+  CHECK(flash.map(flash.size() - 16, 16) != NULL);
+
+  // Non-blocking write completes through poll()
+  CHECK(flash.eraseSector(3));
+  flash.waitUntilReady();
+  fill(buf, 1024, 3);
+  CHECK(flash.startWrite(3 * SFLASH_SECTOR_SIZE, buf, 1024));
+  CHECK(!flash.isDone());
+  while (!flash.poll()) {
+    sim.advanceTime(50);
+  }
+  CHECK(!flash.isFailed());
+  CHECK(memcmp(mem + 3 * SFLASH_SECTOR_SIZE, buf, 1024) == 0);
+
+  // end() completes a pending write
+  CHECK(flash.eraseSector(4));
+  flash.waitUntilReady();
+  CHECK(flash.startWrite(4 * SFLASH_SECTOR_SIZE, buf, 1024));
+  flash.end();
+  CHECK(memcmp(mem + 4 * SFLASH_SECTOR_SIZE, buf, 1024) == 0);
+
+  // Failed page programs of a non-blocking write are reported
+  FailingSim failing;
+  Adafruit_SPIFlashBase flash2(&failing);
+  CHECK(flash2.begin());
+
+  failing.fail_program = true;
+  CHECK(!flash2.startWrite(0, buf, 1024));
+  CHECK(flash2.isDone() && flash2.isFailed());
+  failing.fail_program = false;
+
+  CHECK(flash2.startWrite(0, buf, 1024));
+  failing.fail_program = true;
+  while (!flash2.poll()) {
+    failing.advanceTime(50);
+  }
+  CHECK(flash2.isFailed());
+  failing.fail_program = false;
+
+  CHECK(flash2.eraseSector(0));
+  flash2.waitUntilReady();
+  CHECK(flash2.startWrite(0, buf, 1024));
+  flash2.waitUntilReady();
+  CHECK(!flash2.isFailed());
+  CHECK(memcmp(failing.data(), buf, 1024) == 0);
+
+  return TEST_RESULT();
+}